@@ -0,0 +1,30 @@
+//
+// Created by 7budd on 10/17/2026.
+//
+#include "ASTArena.h"
+
+#include <cstdint>
+
+static const size_t ChunkSize = 64 * 1024;
+
+ASTArena::~ASTArena() {
+    for (auto it = dtors.rbegin(); it != dtors.rend(); it++)
+        it->second(it->first);
+    for (char *chunk : chunks)
+        delete[] chunk;
+}
+
+void *ASTArena::allocate(size_t size, size_t align) {
+    auto p = (char*)(((uintptr_t)cur + align - 1) & ~(uintptr_t)(align - 1));
+    if (!cur || p + size > limit) {
+        //oversized requests get a chunk of their own
+        size_t len = size + align > ChunkSize ? size + align : ChunkSize;
+        chunks.push_back(new char[len]);
+        cur = chunks.back();
+        limit = cur + len;
+        p = (char*)(((uintptr_t)cur + align - 1) & ~(uintptr_t)(align - 1));
+    }
+    cur = p + size;
+    bytes += size;
+    return p;
+}
@@ -0,0 +1,41 @@
+//
+// Created by 7budd on 10/17/2026.
+//
+#ifndef BRAINPLUS_ASTARENA_H
+#define BRAINPLUS_ASTARENA_H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+//bump allocator that owns every AST node of one compilation unit
+//nodes are never deleted individually; the whole arena is released at once when it is destroyed.
+//only node types with non-trivial members (e.g. a std::vector) have their destructors run.
+class ASTArena {
+    std::vector<char*> chunks;
+    char *cur, *limit;
+    size_t bytes;
+    unsigned int nodes;
+    std::vector<std::pair<void*, void (*)(void*)>> dtors;
+    void *allocate(size_t size, size_t align);
+public:
+    ASTArena() : cur(nullptr), limit(nullptr), bytes(0), nodes(0) {}
+    ~ASTArena();
+    ASTArena(const ASTArena&) = delete;
+    ASTArena &operator=(const ASTArena&) = delete;
+
+    template <typename T, typename... Args>
+    T *make(Args&&... args) {
+        T *node = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        if (!std::is_trivially_destructible<T>::value)
+            dtors.emplace_back(node, [](void *p) { ((T*)p)->~T(); });
+        nodes++;
+        return node;
+    }
+    unsigned int getNumNodes() const { return nodes; }
+    size_t getBytesUsed() const { return bytes; }
+};
+
+#endif //BRAINPLUS_ASTARENA_H
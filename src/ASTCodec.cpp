@@ -0,0 +1,263 @@
+//
+// Created by 7budd on 10/18/2026.
+//
+#include "ASTCodec.h"
+
+#include <utility>
+
+namespace {
+    const unsigned char NullNode = 0xff;
+    //deeper nodes are rejected instead of recursing until the stack runs out
+    const unsigned int MaxDepth = 10000;
+
+    bool hasName(const Token& t) {
+        return t.Type == TokenType::t_identifier || t.Type == TokenType::t_string;
+    }
+}
+
+void ASTWriter::u32(uint32_t v) {
+    for (int i = 0; i < 4; i++) Out += (char)(v >> i * 8);
+}
+void ASTWriter::u64(uint64_t v) {
+    for (int i = 0; i < 8; i++) Out += (char)(v >> i * 8);
+}
+void ASTWriter::str(const std::string& s) {
+    u32(s.size());
+    Out += s;
+}
+void ASTWriter::loc(Location l) {
+    i32(l.Line);
+    i32(l.Col);
+}
+void ASTWriter::name(const std::string& s) {
+    if (!table) {
+        str(s);
+        return;
+    }
+    auto it = indices.find(s);
+    if (it == indices.end()) {
+        it = indices.emplace(s, Strings.size()).first;
+        Strings.push_back(s);
+    }
+    u32(it->second);
+}
+void ASTWriter::token(const Token& t) {
+    i32(t.Type);
+    i32(t.Number);
+    i32(t.Op);
+    if (hasName(t)) name(t.getIdentifier());
+    u32(t.Offset);
+    loc(t.Loc);
+}
+void ASTWriter::node(StatementNode *s) {
+    //idioms only exist after optimization
+    if (!s || s->getType() == NodeType::Idiom) {
+        u8(NullNode);
+        return;
+    }
+    u8(s->getType());
+    loc(s->getLoc());
+    switch (s->getType()) {
+        case NodeType::MultiStatement: {
+            auto *m = (MultiStatementNode*)s;
+            u32(m->getNumStatements());
+            for (auto *stat : m->getStatements())
+                node(stat);
+            break;
+        }
+        case NodeType::Number: i32(((NumberNode*)s)->getNumber()); break;
+        case NodeType::Call: name(((CallNode*)s)->getId()); break;
+        case NodeType::NullaryOperator: case NodeType::UnaryOperator: case NodeType::BinaryOperator: {
+            auto *op = (NullaryOperatorNode*)s;
+            i32(op->getOp());
+            i32(op->getOffset());
+            if (s->getType() == NodeType::BinaryOperator)
+                node(((BinaryOperatorNode*)s)->getLHS());
+            if (s->getType() != NodeType::NullaryOperator)
+                node(((UnaryOperatorNode*)s)->getRHS());
+            break;
+        }
+        case NodeType::For: {
+            auto *f = (ForNode*)s;
+            node(f->getStart());
+            node(f->getExpression());
+            node(f->getStep());
+            node(f->getBody());
+            break;
+        }
+        case NodeType::Do: case NodeType::While: case NodeType::If: case NodeType::Ternary: {
+            auto *d = (DoWhileNode*)s;
+            node(d->getExpression());
+            node(d->getBody());
+            if (s->getType() == NodeType::If || s->getType() == NodeType::Ternary)
+                node(((IfTernaryNode*)s)->getElse());
+            break;
+        }
+        default: break;
+    }
+}
+void ASTWriter::defines(const std::vector<DefineNode*> &defs) {
+    u32(defs.size());
+    for (auto def : defs) {
+        name(def->getId());
+        loc(def->getLoc());
+        u32(def->getNumReplacements());
+        for (auto &t : def->getReplacements())
+            token(t);
+    }
+}
+void ASTWriter::functions(const std::vector<FunctionNode*> &funcs) {
+    u32(funcs.size());
+    for (auto func : funcs) {
+        name(func->getId());
+        loc(func->getLoc());
+        node(func->getBody());
+    }
+}
+
+uint32_t ASTReader::u32() {
+    uint32_t v = 0;
+    for (int i = 0; i < 4; i++) v |= (uint32_t)u8() << i * 8;
+    return v;
+}
+uint64_t ASTReader::u64() {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) v |= (uint64_t)u8() << i * 8;
+    return v;
+}
+std::string ASTReader::str() {
+    uint32_t size = u32();
+    if (size > (size_t)(end - cur)) {
+        Ok = false;
+        return "";
+    }
+    cur += size;
+    return std::string(cur - size, size);
+}
+Location ASTReader::loc() {
+    Location l;
+    l.Line = i32();
+    l.Col = i32();
+    return l;
+}
+Symbol ASTReader::name() {
+    if (!symbols) return Interner::Intern(str());
+    uint32_t i = u32();
+    if (i < symbols->size()) return (*symbols)[i];
+    Ok = false;
+    return 0;
+}
+TokenType ASTReader::tokenType() {
+    //keywords and token kinds are negative; anything else is the character itself
+    int t = i32();
+    if (t >= TokenType::t_op && t <= 0xff) return (TokenType)t;
+    Ok = false;
+    return TokenType::t_eof;
+}
+Operator ASTReader::op() {
+    int op = i32();
+    if (op >= Operator::null && op <= Operator::bool_xor) return (Operator)op;
+    Ok = false;
+    return Operator::null;
+}
+Token ASTReader::token() {
+    Token t;
+    t.Type = tokenType();
+    t.Number = i32();
+    t.Op = op();
+    t.Id = hasName(t) ? name() : 0;
+    t.Offset = u32();
+    t.Loc = loc();
+    return t;
+}
+StatementNode *ASTReader::node(ASTArena *arena) {
+    unsigned char type = u8();
+    if (!Ok || type == NullNode) return nullptr;
+    if (depth == MaxDepth) {
+        Ok = false;
+        return nullptr;
+    }
+    depth++;
+    StatementNode *n = decode(arena, type);
+    depth--;
+    return Ok ? n : nullptr;
+}
+StatementNode *ASTReader::child(ASTArena *arena) {
+    StatementNode *n = node(arena);
+    if (!n) Ok = false;
+    return n;
+}
+StatementNode *ASTReader::decode(ASTArena *arena, unsigned char type) {
+    Location l = loc();
+    switch (type) {
+        case NodeType::MultiStatement: {
+            uint32_t n = u32();
+            std::vector<StatementNode*> stats;
+            for (uint32_t i = 0; i < n && Ok; i++)
+                stats.push_back(child(arena));
+            return arena->make<MultiStatementNode>(std::move(stats), l);
+        }
+        case NodeType::Number: return arena->make<NumberNode>(i32(), l);
+        case NodeType::Call: return arena->make<CallNode>(name(), l);
+        case NodeType::NullaryOperator: case NodeType::UnaryOperator: case NodeType::BinaryOperator: {
+            Operator o = op();
+            //offsets are only set by the Optimizer, after nodes are encoded
+            if (i32() != 0) Ok = false;
+            NullaryOperatorNode *n;
+            if (type == NodeType::NullaryOperator)
+                n = arena->make<NullaryOperatorNode>(o, l);
+            else if (type == NodeType::UnaryOperator)
+                n = arena->make<UnaryOperatorNode>(o, child(arena), l);
+            else {
+                StatementNode *lhs = child(arena);
+                n = arena->make<BinaryOperatorNode>(o, lhs, child(arena), l);
+            }
+            return n;
+        }
+        //only the condition is required; the parser leaves out an empty initializer, step or body
+        case NodeType::For: {
+            StatementNode *start = node(arena), *expr = child(arena), *step = node(arena);
+            return arena->make<ForNode>(start, expr, step, node(arena), l);
+        }
+        case NodeType::Do: case NodeType::While: {
+            StatementNode *expr = child(arena);
+            return arena->make<DoWhileNode>(expr, node(arena), type == NodeType::While, l);
+        }
+        case NodeType::If: case NodeType::Ternary: {
+            StatementNode *expr = child(arena), *body = child(arena);
+            bool ternary = type == NodeType::Ternary;
+            return arena->make<IfTernaryNode>(expr, body, ternary ? child(arena) : node(arena), ternary, l);
+        }
+        default:
+            Ok = false;
+            return nullptr;
+    }
+}
+bool ASTReader::defines(ASTArena *arena, std::vector<DefineNode*> &out) {
+    std::vector<DefineNode*> defs;
+    uint32_t n = u32();
+    for (uint32_t i = 0; i < n && Ok; i++) {
+        Symbol id = name();
+        Location l = loc();
+        std::vector<Token> rep;
+        uint32_t tokens = u32();
+        for (uint32_t j = 0; j < tokens && Ok; j++)
+            rep.push_back(token());
+        defs.push_back(arena->make<DefineNode>(id, std::move(rep), l));
+    }
+    if (!Ok) return false;
+    out.insert(out.end(), defs.begin(), defs.end());
+    return true;
+}
+bool ASTReader::functions(ASTArena *arena, std::vector<FunctionNode*> &out) {
+    std::vector<FunctionNode*> funcs;
+    uint32_t n = u32();
+    for (uint32_t i = 0; i < n && Ok; i++) {
+        Symbol id = name();
+        Location l = loc();
+        funcs.push_back(arena->make<FunctionNode>(id, node(arena), l));
+    }
+    if (!Ok) return false;
+    out.insert(out.end(), funcs.begin(), funcs.end());
+    return true;
+}
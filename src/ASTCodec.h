@@ -0,0 +1,76 @@
+//
+// Created by 7budd on 10/18/2026.
+//
+#ifndef BRAINPLUS_ASTCODEC_H
+#define BRAINPLUS_ASTCODEC_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "ASTNodes.h"
+
+//Binary encoding of tokens and AST nodes, shared by ParseCache and Module
+//integers are little-endian regardless of the host. nodes are written in pre-order.
+//names are written inline, or as indices into a string table when the writer keeps one (the reader is then given
+//the table's symbols). only node types the parser creates are encoded; anything else is written as a null node.
+class ASTWriter {
+    bool table;
+    std::map<std::string, uint32_t> indices;
+public:
+    std::string Out;
+    std::vector<std::string> Strings;   //the string table, in index order
+
+    explicit ASTWriter(bool table = false) : table(table) {}
+    void u8(unsigned char v) { Out += (char)v; }
+    void u32(uint32_t v);
+    void u64(uint64_t v);
+    void i32(int v) { u32((uint32_t)v); }
+    void str(const std::string& s);
+    void loc(Location l);
+    void name(const std::string& s);
+    void token(const Token& t);
+    void node(StatementNode *s);
+    //a count, then each definition's name, location and replacement tokens or body
+    void defines(const std::vector<DefineNode*> &defs);
+    void functions(const std::vector<FunctionNode*> &funcs);
+};
+//every read past the end yields 0 and clears Ok, so callers only check once they are done
+class ASTReader {
+    const char *cur, *end;
+    const std::vector<Symbol> *symbols;
+    unsigned int depth;
+    //a node that must be there: a null one clears Ok
+    StatementNode *child(ASTArena *arena);
+    StatementNode *decode(ASTArena *arena, unsigned char type);
+public:
+    bool Ok;
+
+    ASTReader(const char *begin, const char *end, const std::vector<Symbol> *symbols = nullptr) :
+        cur(begin), end(end), symbols(symbols), depth(0), Ok(true) {}
+    bool done() const { return cur == end; }
+    //names read from here on are indices into `table`
+    void useTable(const std::vector<Symbol> *table) { symbols = table; }
+    unsigned char u8() {
+        if (cur == end) return Ok = false;
+        return *cur++;
+    }
+    uint32_t u32();
+    uint64_t u64();
+    int i32() { return (int)u32(); }
+    std::string str();
+    Location loc();
+    Symbol name();
+    //out of range values clear Ok
+    TokenType tokenType();
+    Operator op();
+    Token token();
+    //nodes are allocated in `arena`. a node the parser can't produce (a missing operand or condition, or nesting
+    //too deep to decode) clears Ok
+    StatementNode *node(ASTArena *arena);
+    //append to `out` and return true only if the whole list was read
+    bool defines(ASTArena *arena, std::vector<DefineNode*> &out);
+    bool functions(ASTArena *arena, std::vector<FunctionNode*> &out);
+};
+
+#endif //BRAINPLUS_ASTCODEC_H
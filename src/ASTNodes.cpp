@@ -5,16 +5,18 @@
 
 std::string StatementNode::to_string() { return "Statement" + ASTNode::to_string(); }
 std::string MultiStatementNode::to_string() {
-    if (Statements->empty()) return "";
+    if (Statements.empty()) return "";
     std::string ret;
-    for (StatementNode *st : *Statements)
+    for (StatementNode *st : Statements)
         ret += '\n' + st->to_string();
     return ret.substr(1);
 }
 std::string NumberNode::to_string() { return std::to_string(Number); }
-std::string CallNode::to_string() { return Id; }
-std::string NullaryOperatorNode::to_string() { return EnumOps::OpToStr(Op); }
-std::string UnaryOperatorNode::to_string() { return EnumOps::OpToStr(Op) + NodeOps::Parenthesize(RHS); }
+std::string CallNode::to_string() { return getId(); }
+std::string NullaryOperatorNode::to_string() { return NodeOps::OffsetPrefix(Offset) + EnumOps::OpToStr(Op); }
+std::string UnaryOperatorNode::to_string() {
+    return NodeOps::OffsetPrefix(Offset) + EnumOps::OpToStr(Op) + NodeOps::Parenthesize(RHS);
+}
 std::string BinaryOperatorNode::to_string() { return NodeOps::Parenthesize(LHS) + UnaryOperatorNode::to_string(); }
 std::string DoWhileNode::to_string() {
     if (Type == NodeType::While)
@@ -37,11 +39,12 @@ std::string ForNode::to_string() {
     return "for (" + (Start ? Start->to_string() : "") + "; " + Expression->to_string() + "; "
            + (Step ? Step->to_string() : "") + ") {" + (Body ? '\n' + Body->to_string() + '\n' : "") + '}';
 }
-std::string IncludeNode::to_string() { return "include \"" + Id + '"'; }
+std::string IdiomNode::to_string() { return Idiom.to_string(); }
+std::string IncludeNode::to_string() { return "include \"" + getId() + '"'; }
 std::string DefineNode::to_string() {
     std::string str;
-    for (const auto& tok : *Replacement)
-        str += " " + tok->toString();
-    return "define " + Id + ":" + str;
+    for (const auto& tok : Replacement)
+        str += " " + tok.toString();
+    return "define " + getId() + ":" + str;
 }
-std::string FunctionNode::to_string() { return Id + " {\n" + Statement->to_string() + "\n}"; }
+std::string FunctionNode::to_string() { return getId() + " {\n" + Statement->to_string() + "\n}"; }
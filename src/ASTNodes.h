@@ -7,16 +7,19 @@
 #include <utility>
 #include <vector>
 #include "Lexer.h"
+#include "ASTArena.h"
+#include "LoopIdiom.h"
 
 //Base Abstract Syntax Tree Node class
+//nodes are allocated in an ASTArena and never deleted individually, so they don't own their children
 class ASTNode {
     Location Loc;
 protected:
     NodeType Type;
+    ~ASTNode() = default;
 public:
     ASTNode(Location l, NodeType t) : Loc(l), Type(t) {}
     explicit ASTNode(Location l) : ASTNode(l, NodeType::Base) {}
-    virtual ~ASTNode() = default;
 
     int getLine() const { return Loc.Line; }
     int getCol() const { return Loc.Col; }
@@ -33,86 +36,81 @@ protected:
     StatementNode(Location l, NodeType t) : ASTNode(l, t) {}
     explicit StatementNode(Location l) : StatementNode(l, NodeType::Statement) {}
 public:
-    ~StatementNode() override = default;
     std::string to_string() override;
 };
 class MultiStatementNode : public StatementNode {
-    std::vector<StatementNode*> *Statements;
+    std::vector<StatementNode*> Statements;
 public:
-    MultiStatementNode(std::vector<StatementNode*> *statements, Location l) : StatementNode(l, NodeType::MultiStatement),
-        Statements(statements == nullptr ? new std::vector<StatementNode*> : statements) {}
-    explicit MultiStatementNode(Location l) : MultiStatementNode(nullptr, l) {}
-    ~MultiStatementNode() override {
-        while (!Statements->empty()) {
-            delete Statements->back();
-            Statements->pop_back();
-        }
-        delete Statements;
-    }
+    MultiStatementNode(std::vector<StatementNode*> statements, Location l) : StatementNode(l, NodeType::MultiStatement),
+        Statements(std::move(statements)) {}
+    explicit MultiStatementNode(Location l) : StatementNode(l, NodeType::MultiStatement) {}
 
     std::string to_string() override;
 
     void addStatement(StatementNode *statement) {
         if (statement->getType() == NodeType::MultiStatement)
             addAllStatements((MultiStatementNode*)statement);
-        else Statements->push_back(statement);
+        else Statements.push_back(statement);
     }
     void addAllStatements(MultiStatementNode *multi) {
-        for (auto *node : *multi->Statements)
+        for (auto *node : multi->Statements)
             addStatement(node);
     }
     bool insertStatement(StatementNode *statement, int index) {
         if (statement->getType() == NodeType::MultiStatement)
             return insertAllStatements((MultiStatementNode*)statement, index);
-        if (index < 0 || index > Statements->size())
+        if (index < 0 || index > Statements.size())
             return false;
-        Statements->insert(Statements->begin() + index, statement);
+        Statements.insert(Statements.begin() + index, statement);
         return true;
     }
     bool insertAllStatements(MultiStatementNode *multi, int index) {
-        if (index < 0 || index > Statements->size())
+        if (index < 0 || index > Statements.size())
             return false;
-        Statements->insert(Statements->begin() + index, multi->Statements->begin(), multi->Statements->end());
+        Statements.insert(Statements.begin() + index, multi->Statements.begin(), multi->Statements.end());
         return true;
     }
     bool removeStatement(int index) {
-        if (index < 0 || index >= Statements->size())
+        if (index < 0 || index >= Statements.size())
             return false;
-        Statements->erase(Statements->begin() + index);
+        Statements.erase(Statements.begin() + index);
         return true;
     }
     bool removeStatement(StatementNode *statement) {
-        auto elem = std::find(Statements->begin(), Statements->end(), statement);
-        if (elem == Statements->end()) return false;
-        Statements->erase(elem);
+        auto elem = std::find(Statements.begin(), Statements.end(), statement);
+        if (elem == Statements.end()) return false;
+        Statements.erase(elem);
         return true;
     }
-    unsigned int getNumStatements() { return Statements->size(); }
-    StatementNode* getStatement(int index) { return Statements->at(index); }
+    unsigned int getNumStatements() { return Statements.size(); }
+    StatementNode* getStatement(int index) { return Statements.at(index); }
+    std::vector<StatementNode*> &getStatements() { return Statements; }
 };
 class NumberNode : public StatementNode {
     int Number;
 public:
     NumberNode(int n, Location l) : StatementNode(l, NodeType::Number), Number(n) {}
-    ~NumberNode() override = default;
+    int getNumber() { return Number; }
     std::string to_string() override;
 };
 class CallNode : public StatementNode {
-    std::string Id;
+    Symbol Id;
 public:
-    CallNode(std::string id, Location l) : StatementNode(l), Id(std::move(id)) { Type = NodeType::Call; }
-    ~CallNode() override = default;
-    std::string getId() { return Id; }
+    CallNode(Symbol id, Location l) : StatementNode(l), Id(id) { Type = NodeType::Call; }
+    Symbol getSymbol() { return Id; }
+    const std::string &getId() { return Interner::Lookup(Id); }
     std::string to_string() override;
 };
 //Operator nodes
 class NullaryOperatorNode : public StatementNode {
 protected:
     Operator Op;
+    int Offset;     //cell ops act on the cell at ptr + Offset. set by the Optimizer, 0 when parsed
 public:
-    NullaryOperatorNode(Operator op, Location l) : StatementNode(l, NodeType::NullaryOperator), Op(op) {}
-    ~NullaryOperatorNode() override = default;
+    NullaryOperatorNode(Operator op, Location l) : StatementNode(l, NodeType::NullaryOperator), Op(op), Offset(0) {}
     Operator getOp() { return Op; }
+    int getOffset() { return Offset; }
+    void setOffset(int offset) { Offset = offset; }
     std::string to_string() override;
 };
 class UnaryOperatorNode : public NullaryOperatorNode {
@@ -121,7 +119,8 @@ protected:
 public:                 //if RHS = null, implied default number
     UnaryOperatorNode(Operator op, StatementNode *rhs, Location l) : NullaryOperatorNode(op, l),
         RHS(rhs) { Type = NodeType::UnaryOperator; }
-    ~UnaryOperatorNode() override { delete RHS; }
+    StatementNode *getRHS() { return RHS; }
+    void setRHS(StatementNode *rhs) { RHS = rhs; }
     std::string to_string() override;
 };
 class BinaryOperatorNode : public UnaryOperatorNode {
@@ -129,7 +128,8 @@ class BinaryOperatorNode : public UnaryOperatorNode {
 public:                 //RHS = number or ptr lookup if comp op, else bool expr
     BinaryOperatorNode(Operator op, StatementNode *lhs, StatementNode *rhs, Location l) :
         UnaryOperatorNode(op, rhs, l), LHS(lhs) { Type = NodeType::BinaryOperator; }
-    ~BinaryOperatorNode() override { delete LHS; }
+    StatementNode *getLHS() { return LHS; }
+    void setLHS(StatementNode *lhs) { LHS = lhs; }
     std::string to_string() override;
 };
 //Control statement nodes
@@ -141,7 +141,10 @@ public:
         StatementNode(l), Expression(expr), Body(body) { Type = isWhile ? NodeType::While : NodeType::Do; }
     DoWhileNode(StatementNode *expr, StatementNode *body, Location l) :
         DoWhileNode(expr, body, false, l) {}
-    ~DoWhileNode() override { delete Expression; delete Body; }
+    StatementNode *getExpression() { return Expression; }
+    StatementNode *getBody() { return Body; }
+    void setExpression(StatementNode *expr) { Expression = expr; }
+    void setBody(StatementNode *body) { Body = body; }
     std::string to_string() override;
 };
 class IfTernaryNode : public DoWhileNode {
@@ -151,7 +154,8 @@ public:
         DoWhileNode(expr, body, l), Else(elseBody) { Type = isTernary ? NodeType::Ternary : NodeType::If; }
     IfTernaryNode(StatementNode *expr, StatementNode *body, StatementNode *elseBody, Location l) :
             IfTernaryNode(expr, body, elseBody, false, l) {}
-    ~IfTernaryNode() override { delete Else; }
+    StatementNode *getElse() { return Else; }
+    void setElse(StatementNode *elseBody) { Else = elseBody; }
     std::string to_string() override;
 };
 class ForNode : public DoWhileNode {
@@ -159,65 +163,72 @@ class ForNode : public DoWhileNode {
 public:
     ForNode(StatementNode *start, StatementNode *expr, StatementNode *step, StatementNode *body, Location l) :
         DoWhileNode(expr, body, l), Start(start), Step(step) { Type = NodeType::For; }
-    ~ForNode() override { delete Start; delete Step; }
+    StatementNode *getStart() { return Start; }
+    StatementNode *getStep() { return Step; }
+    void setStart(StatementNode *start) { Start = start; }
+    void setStep(StatementNode *step) { Step = step; }
+    std::string to_string() override;
+};
+//closed form of a loop replaced by the Optimizer
+class IdiomNode : public StatementNode {
+    LoopIdiom Idiom;
+public:
+    IdiomNode(LoopIdiom idiom, Location l) : StatementNode(l, NodeType::Idiom), Idiom(std::move(idiom)) {}
+    const LoopIdiom &getIdiom() { return Idiom; }
     std::string to_string() override;
 };
 
 //Include, define, and function definition nodes
 class IncludeNode : public ASTNode {
 protected:
-    std::string Id;
+    Symbol Id;
 public:
-    IncludeNode(std::string id, Location l) : ASTNode(l, NodeType::Include), Id(std::move(id)) {}
-    ~IncludeNode() override = default;
-    std::string getFname() { return Id.substr(Id.rfind('\\')+1); }
-    std::string getDir() { unsigned int i; return (i = Id.rfind('\\')) == -1 ? "." : Id.substr(0, i+1); }
-    std::string getId() { return Id; }
+    IncludeNode(Symbol id, Location l) : ASTNode(l, NodeType::Include), Id(id) {}
+    IncludeNode(const std::string& id, Location l) : IncludeNode(Interner::Intern(id), l) {}
+    std::string getFname() { return getId().substr(getId().rfind('\\')+1); }
+    std::string getDir() { unsigned int i; return (i = getId().rfind('\\')) == -1 ? "." : getId().substr(0, i+1); }
+    Symbol getSymbol() { return Id; }
+    const std::string &getId() { return Interner::Lookup(Id); }
     std::string to_string() override;
 };
 class DefineNode : public IncludeNode {
 protected:
-    std::vector<Token*> *Replacement;
+    std::vector<Token> Replacement;
 public:
-    DefineNode(std::string id, std::vector<Token*> *replacement, Location l) : IncludeNode(std::move(id), l),
-        Replacement(replacement) { Type = NodeType::Define; }
-    ~DefineNode() override {
-        while (!Replacement->empty()) {
-            delete Replacement->back();
-            Replacement->pop_back();
-        }
-        delete Replacement;
-    }
+    DefineNode(Symbol id, std::vector<Token> replacement, Location l) : IncludeNode(id, l),
+        Replacement(std::move(replacement)) { Type = NodeType::Define; }
 
-    std::vector<Token*> *getReplacements() { return Replacement; }
-    unsigned int getNumReplacements() { return Replacement->size(); }
-    Token *getReplacement(int i) { return Replacement->at(i); }
-    void setReplacement(std::vector<Token*> *rep, int i) {
-        Replacement->erase(Replacement->begin() + i);
-        Replacement->insert(Replacement->begin() + i, rep->begin(), rep->end());
-    }
+    const std::vector<Token> &getReplacements() { return Replacement; }
+    unsigned int getNumReplacements() { return Replacement.size(); }
+    const Token &getReplacement(int i) { return Replacement[i]; }
+    void setReplacements(std::vector<Token> rep) { Replacement = std::move(rep); }
     std::string to_string() override;
 };
 class FunctionNode : public IncludeNode {
 protected:
     StatementNode *Statement;
 public:
-    FunctionNode(std::string id, StatementNode *statement, Location l) :
-        IncludeNode(std::move(id), l), Statement(statement) { Type = NodeType::Function; }
-    ~FunctionNode() override { delete Statement; }
+    FunctionNode(Symbol id, StatementNode *statement, Location l) :
+        IncludeNode(id, l), Statement(statement) { Type = NodeType::Function; }
     StatementNode *getBody() { return Statement; }
+    void setBody(StatementNode *statement) { Statement = statement; }
     std::string to_string() override;
 };
 
 class NodeOps {
 public:
-    static UnaryOperatorNode *CurrentValLookup(Location l) {
-        return new UnaryOperatorNode(Operator::ptr_lookupRelUp, new NumberNode(0, l), l);
+    static UnaryOperatorNode *CurrentValLookup(ASTArena *arena, Location l) {
+        return arena->make<UnaryOperatorNode>(Operator::ptr_lookupRelUp, arena->make<NumberNode>(0, l), l);
     }
     static bool HasNumberReturn(StatementNode *s) {
         return s->getType() == NodeType::Number || s->getType() == NodeType::Ternary || s->getType() == NodeType::BinaryOperator ||
             s->getType() == NodeType::UnaryOperator && EnumOps::OpIsPtrLookup(((UnaryOperatorNode*)s)->getOp());
     }
+    //prefix shown before ops with a cell offset, e.g. [@+2]+1
+    static std::string OffsetPrefix(int offset) {
+        if (!offset) return "";
+        return offset > 0 ? "[@+" + std::to_string(offset) + ']' : "[@-" + std::to_string(-(long long)offset) + ']';
+    }
     static std::string Parenthesize(StatementNode *s) {
         if (!s) return "";
         if (s->getType() == NodeType::Number || s->getType() == NodeType::UnaryOperator &&
@@ -0,0 +1,18 @@
+//
+// Created by 7budd on 10/18/2026.
+//
+#ifndef BRAINPLUS_ARITH_H
+#define BRAINPLUS_ARITH_H
+
+//cell and pointer arithmetic shared by the engines: two's complement wraparound on overflow.
+//done through unsigned so overflow is defined, the same as the runtime of the emitted C (bp_wrap, bp_quot)
+class Arith {
+public:
+    static int Add(int a, int b) { return (int)((unsigned int)a + (unsigned int)b); }
+    static int Sub(int a, int b) { return (int)((unsigned int)a - (unsigned int)b); }
+    static int Mul(int a, int b) { return (int)((unsigned int)a * (unsigned int)b); }
+    //b must not be 0. INT_MIN / -1 wraps to INT_MIN instead of trapping
+    static int Quot(int a, int b) { return b == -1 ? Sub(0, a) : a / b; }
+};
+
+#endif //BRAINPLUS_ARITH_H
@@ -0,0 +1,275 @@
+//
+// Created by 7budd on 10/18/2026.
+//
+#include "Bytecode.h"
+
+#include <exception>
+
+//Bytecode
+const char *Bytecode::OpName(OpCode op) {
+#define BYTECODE_NAME(op) #op,
+    static const char *names[] = { BYTECODE_OPS(BYTECODE_NAME) };
+#undef BYTECODE_NAME
+    return op < bc_numOps ? names[op] + 3 : "?";
+}
+std::string Bytecode::to_string() const {
+    std::string str;
+    for (unsigned int f = 0; f < Functions.size(); f++) {
+        unsigned int end = f + 1 < Functions.size() ? Functions[f + 1].Entry : Code.size();
+        str += (f == 0 ? std::string("main") : Interner::Lookup(Functions[f].Id)) +
+               " (" + std::to_string(Functions[f].Frame) + " registers):\n";
+        for (unsigned int pc = Functions[f].Entry; pc < end; pc++)
+            str += "  " + std::to_string(pc) + "\t" + OpName(Code[pc].Op) + ' ' + std::to_string(Code[pc].A) + ' ' +
+                   std::to_string(Code[pc].B) + ' ' + std::to_string(Code[pc].C) + '\n';
+    }
+    return str;
+}
+
+//BytecodeCompiler
+unsigned int BytecodeCompiler::emit(OpCode op, Location l, int a, int b, int c) {
+    prog->Code.push_back({op, a, b, c});
+    prog->Locs.push_back(l);
+    return prog->Code.size() - 1;
+}
+int BytecodeCompiler::function(Symbol id, Location l) {
+    if (ast->getFunction(id) == FlatAST::None)
+        throw std::exception(("UnknownIdentifierException: Unknown function \"" + Interner::Lookup(id) +
+                              "\" at " + l.toString()).c_str());
+    if (id >= funcIndex.size())
+        funcIndex.resize(id + 1, -1);
+    if (funcIndex[id] < 0) {
+        funcIndex[id] = (int)prog->Functions.size();
+        prog->Functions.push_back({id, 0, 0});
+        pending.push_back(funcIndex[id]);
+    }
+    return funcIndex[id];
+}
+
+//cell offset of op n, recorded in the program's reach
+int BytecodeCompiler::offset(unsigned int n) {
+    int o = ast->getValue(n);
+    if (o > prog->Reach) prog->Reach = o;
+    return o;
+}
+
+void BytecodeCompiler::compileUnary(unsigned int n, int dst, bool want) {
+    Operator op = ast->getOp(n);
+    Location l = ast->getLoc(n);
+    unsigned int rhs = ast->getChild(n, 0);
+    int o = offset(n);
+    enum { val, ptr, none } result = none;
+    //constant operands use the immediate forms
+    if (rhs == FlatAST::None || ast->getKind(rhs) == NodeType::Number) {
+        int k = rhs == FlatAST::None ? 0 : ast->getValue(rhs);
+        result = val;
+        switch (op) {
+            case addition:          emit(bc_addi, l, 0, k, o); break;
+            case subtraction:       emit(bc_subi, l, 0, k, o); break;
+            case multiplication:    emit(bc_muli, l, 0, k, o); break;
+            case assignment:        emit(bc_seti, l, 0, k, o); break;
+            case ptr_addition:      emit(bc_paddi, l, 0, k); result = ptr; break;
+            case ptr_subtraction:   emit(bc_psubi, l, 0, k); result = ptr; break;
+            case ptr_assignment:    emit(bc_pseti, l, 0, k); result = ptr; break;
+            case ptr_store:         emit(bc_storei, l, 0, k); result = ptr; break;
+            case ptr_lookup:        emit(bc_loadi, l, dst, k); return;
+            case ptr_lookupRelUp:   k ? emit(bc_loadupi, l, dst, o + k) : emit(bc_cell, l, dst, 0, o); return;
+            case ptr_lookupRelDown:
+                if (!k) emit(bc_cell, l, dst, 0, o);
+                else o ? emit(bc_loadupi, l, dst, o - k) : emit(bc_loaddni, l, dst, k);
+                return;
+            default: result = none; break;
+        }
+    }
+    if (result == none) {
+        if (EnumOps::OpIsValComp(op) || EnumOps::OpIsPtrComp(op)) {
+            //compares the cell or ptr with the operand
+            compile(rhs, dst + 1, true);
+            emit(EnumOps::OpIsValComp(op) ? bc_cell : bc_getptr, l, dst, 0, o);
+            OpCode cmp;
+            switch (op) {
+                case lessThan: case ptr_lessThan:             cmp = bc_lt; break;
+                case greaterThan: case ptr_greaterThan:       cmp = bc_gt; break;
+                case lessOrEqual: case ptr_lessOrEqual:       cmp = bc_le; break;
+                case greaterOrEqual: case ptr_greaterOrEqual: cmp = bc_ge; break;
+                case equalTo: case ptr_equalTo:               cmp = bc_eq; break;
+                default:                                      cmp = bc_ne; break;
+            }
+            emit(cmp, l, dst, dst, dst + 1);
+            return;
+        }
+        if (rhs == FlatAST::None) emit(bc_loadk, l, dst, 0);
+        else compile(rhs, dst, true);
+        result = val;
+        switch (op) {
+            case addition:           emit(bc_add, l, 0, dst, o); break;
+            case subtraction:        emit(bc_sub, l, 0, dst, o); break;
+            case multiplication:     emit(bc_mul, l, 0, dst, o); break;
+            case division:           emit(bc_div, l, 0, dst, o); break;
+            case assignment:         emit(bc_set, l, 0, dst, o); break;
+            case bit_not:            emit(bc_not, l, 0, dst, o); break;
+            case bit_and:            emit(bc_and, l, 0, dst, o); break;
+            case bit_or:             emit(bc_or, l, 0, dst, o); break;
+            case bit_xor:            emit(bc_xor, l, 0, dst, o); break;
+            case ptr_addition:       emit(bc_padd, l, 0, dst); result = ptr; break;
+            case ptr_subtraction:    emit(bc_psub, l, 0, dst); result = ptr; break;
+            case ptr_multiplication: emit(bc_pmul, l, 0, dst); result = ptr; break;
+            case ptr_division:       emit(bc_pdiv, l, 0, dst); result = ptr; break;
+            case ptr_assignment:     emit(bc_pset, l, 0, dst); result = ptr; break;
+            case ptr_not:            emit(bc_pnot, l, 0, dst); result = ptr; break;
+            case ptr_and:            emit(bc_pand, l, 0, dst); result = ptr; break;
+            case ptr_or:             emit(bc_por, l, 0, dst); result = ptr; break;
+            case ptr_xor:            emit(bc_pxor, l, 0, dst); result = ptr; break;
+            case ptr_store:          emit(bc_store, l, 0, dst); result = ptr; break;
+            case ptr_lookup:         emit(bc_load, l, dst, dst); return;
+            case ptr_lookupRelUp:    emit(bc_loadup, l, dst, dst, o); return;
+            case ptr_lookupRelDown:  emit(bc_loaddn, l, dst, dst, o); return;
+            case bool_not:           emit(bc_lnot, l, dst, dst); return;
+            default:
+                throw std::exception(("CompileException: Unexpected operator " + EnumOps::OpToStr(op) +
+                                      " at " + l.toString()).c_str());
+        }
+    }
+    if (want) emit(result == ptr ? bc_getptr : bc_cell, l, dst, 0, o);
+}
+void BytecodeCompiler::compileBinary(unsigned int n, int dst) {
+    Operator op = ast->getOp(n);
+    Location l = ast->getLoc(n);
+    unsigned int lhs = ast->getChild(n, 0), rhs = ast->getChild(n, 1), jump, end;
+    compile(lhs, dst, true);
+    switch (op) {
+        case bool_and:  //dst is already 0 if the jump is taken
+            jump = emit(bc_jz, l, dst);
+            compile(rhs, dst, true);
+            emit(bc_truth, l, dst, dst);
+            patch(jump, here());
+            return;
+        case bool_or:
+            jump = emit(bc_jnz, l, dst);
+            compile(rhs, dst, true);
+            emit(bc_truth, l, dst, dst);
+            end = emit(bc_jmp, l);
+            patch(jump, here());
+            emit(bc_loadk, l, dst, 1);
+            patch(end, here());
+            return;
+        default: break;
+    }
+    compile(rhs, dst + 1, true);
+    OpCode cmp;
+    switch (op) {
+        case lessThan:       cmp = bc_lt; break;
+        case greaterThan:    cmp = bc_gt; break;
+        case lessOrEqual:    cmp = bc_le; break;
+        case greaterOrEqual: cmp = bc_ge; break;
+        case equalTo:        cmp = bc_eq; break;
+        case notEqual:       cmp = bc_ne; break;
+        case bool_xor:       cmp = bc_lxor; break;
+        default:
+            throw std::exception(("CompileException: Unexpected operator " + EnumOps::OpToStr(op) +
+                                  " at " + l.toString()).c_str());
+    }
+    emit(cmp, l, dst, dst, dst + 1);
+}
+void BytecodeCompiler::compile(unsigned int n, int dst, bool want) {
+    if (dst + 2 > maxReg) maxReg = dst + 2;
+    Location l = ast->getLoc(n);
+    unsigned int jump, end, top;
+    switch (ast->getKind(n)) {
+        case NodeType::MultiStatement:
+            if (ast->getNumChildren(n) == 0 && want)
+                emit(bc_loadk, l, dst, 0);
+            for (unsigned int i = 0; i < ast->getNumChildren(n); i++)
+                compile(ast->getChild(n, i), dst, want && i + 1 == ast->getNumChildren(n));
+            return;
+        case NodeType::Number:
+            if (want) emit(bc_loadk, l, dst, ast->getValue(n));
+            return;
+        case NodeType::Call:
+            emit(bc_call, l, dst, function((Symbol)ast->getValue(n), l));
+            return;
+        case NodeType::NullaryOperator:
+            emit(ast->getOp(n) == Operator::print ? bc_print : bc_read, l, 0, 0, offset(n));
+            if (want) emit(bc_cell, l, dst, 0, ast->getValue(n));
+            return;
+        case NodeType::UnaryOperator: compileUnary(n, dst, want); return;
+        case NodeType::BinaryOperator: compileBinary(n, dst); return;
+        //loops test their condition at the bottom so each iteration takes a single branch
+        case NodeType::While:
+            jump = emit(bc_jmp, l);
+            top = here();
+            if (ast->getChild(n, 1) != FlatAST::None) compile(ast->getChild(n, 1), dst, false);
+            patch(jump, here());
+            compile(ast->getChild(n, 0), dst, true);
+            emit(bc_jnz, l, dst, top);
+            break;
+        case NodeType::Do:
+            top = here();
+            if (ast->getChild(n, 1) != FlatAST::None) compile(ast->getChild(n, 1), dst, false);
+            compile(ast->getChild(n, 0), dst, true);
+            emit(bc_jnz, l, dst, top);
+            break;
+        case NodeType::For:
+            if (ast->getChild(n, 0) != FlatAST::None) compile(ast->getChild(n, 0), dst, false);
+            jump = emit(bc_jmp, l);
+            top = here();
+            if (ast->getChild(n, 3) != FlatAST::None) compile(ast->getChild(n, 3), dst, false);
+            if (ast->getChild(n, 2) != FlatAST::None) compile(ast->getChild(n, 2), dst, false);
+            patch(jump, here());
+            compile(ast->getChild(n, 1), dst, true);
+            emit(bc_jnz, l, dst, top);
+            break;
+        case NodeType::If:
+            compile(ast->getChild(n, 0), dst, true);
+            jump = emit(bc_jz, l, dst);
+            if (ast->getChild(n, 1) != FlatAST::None) compile(ast->getChild(n, 1), dst, false);
+            if (ast->getChild(n, 2) != FlatAST::None) {
+                end = emit(bc_jmp, l);
+                patch(jump, here());
+                compile(ast->getChild(n, 2), dst, false);
+                patch(end, here());
+            } else patch(jump, here());
+            break;
+        //clears run inline, the other idioms call their closed form
+        case NodeType::Idiom: {
+            const LoopIdiom *idiom = ast->getIdiom(n);
+            if (idiom->Type == LoopIdiom::Clear)
+                emit(bc_clear, l, idiom->Cond == notEqual ? 0 : idiom->Cond == greaterThan ? 1 : -1);
+            else {
+                emit(bc_idiom, l, 0, (int)prog->Idioms.size());
+                prog->Idioms.push_back(idiom);
+            }
+            break;
+        }
+        case NodeType::Ternary:
+            compile(ast->getChild(n, 0), dst, true);
+            jump = emit(bc_jz, l, dst);
+            compile(ast->getChild(n, 1), dst, true);
+            end = emit(bc_jmp, l);
+            patch(jump, here());
+            compile(ast->getChild(n, 2), dst, true);
+            patch(end, here());
+            return;
+        default:
+            throw std::exception(("CompileException: Cannot compile " + ast->to_string(n) + " at " + l.toString()).c_str());
+    }
+    //control statements evaluate to 0
+    if (want) emit(bc_loadk, l, dst, 0);
+}
+void BytecodeCompiler::compileFunction(unsigned int index, unsigned int root, OpCode end) {
+    maxReg = 1;
+    prog->Functions[index].Entry = here();
+    if (root == FlatAST::None) emit(bc_loadk, {0, 0}, 0, 0);
+    else compile(root, 0, true);
+    emit(end, root == FlatAST::None ? Location{0, 0} : ast->getLoc(root));
+    prog->Functions[index].Frame = maxReg;
+}
+Bytecode *BytecodeCompiler::compile(unsigned int root) {
+    prog = new Bytecode();
+    funcIndex.clear();
+    pending.clear();
+    prog->Functions.push_back({0, 0, 0});
+    compileFunction(0, root, bc_halt);
+    for (unsigned int i = 0; i < pending.size(); i++)
+        compileFunction(pending[i], ast->getFunction(prog->Functions[pending[i]].Id), bc_ret);
+    return prog;
+}
@@ -0,0 +1,121 @@
+//
+// Created by 7budd on 10/18/2026.
+//
+#ifndef BRAINPLUS_BYTECODE_H
+#define BRAINPLUS_BYTECODE_H
+
+#include <string>
+#include <vector>
+#include "FlatAST.h"
+
+//Register bytecode executed by the VM
+//every instruction has an opcode and up to three int operands. A is usually the destination register,
+//B and C are source registers, or an immediate/jump target for the *i, jump and call forms.
+//registers are relative to the current function's frame. cell and ptr ops don't write a register;
+//when their value is used the compiler follows them with bc_cell / bc_getptr.
+//"cell" is tape[ptr + C]: C is the cell offset the Optimizer gave the op (never more than Reach), and 0 otherwise.
+#define BYTECODE_OPS(X) \
+    X(bc_halt)      /* stop                                  */ \
+    X(bc_ret)       /* return from function                  */ \
+    X(bc_call)      /* call function B, frame starts at r[A] */ \
+    X(bc_jmp)       /* goto B                                */ \
+    X(bc_jz)        /* if !r[A] goto B                       */ \
+    X(bc_jnz)       /* if r[A] goto B                        */ \
+    X(bc_loadk)     /* r[A] = B                              */ \
+    X(bc_cell)      /* r[A] = cell                           */ \
+    X(bc_getptr)    /* r[A] = ptr                            */ \
+    X(bc_load)      /* r[A] = tape[r[B]]                     */ \
+    X(bc_loadi)     /* r[A] = tape[B]                        */ \
+    X(bc_loadup)    /* r[A] = tape[ptr + C + r[B]]           */ \
+    X(bc_loadupi)   /* r[A] = tape[ptr + B]                  */ \
+    X(bc_loaddn)    /* r[A] = tape[ptr + C - r[B]]           */ \
+    X(bc_loaddni)   /* r[A] = tape[ptr - B]                  */ \
+    X(bc_add)       /* cell += r[B]                          */ \
+    X(bc_sub)       /* cell -= r[B]                          */ \
+    X(bc_mul)       /* cell *= r[B]                          */ \
+    X(bc_div)       /* cell /= r[B]                          */ \
+    X(bc_set)       /* cell = r[B]                           */ \
+    X(bc_not)       /* cell = ~r[B]                          */ \
+    X(bc_and)       /* cell &= r[B]                          */ \
+    X(bc_or)        /* cell |= r[B]                          */ \
+    X(bc_xor)       /* cell ^= r[B]                          */ \
+    X(bc_addi)      /* cell += B                             */ \
+    X(bc_subi)      /* cell -= B                             */ \
+    X(bc_muli)      /* cell *= B                             */ \
+    X(bc_seti)      /* cell = B                              */ \
+    X(bc_padd)      /* ptr += r[B]                           */ \
+    X(bc_psub)      /* ptr -= r[B]                           */ \
+    X(bc_pmul)      /* ptr *= r[B]                           */ \
+    X(bc_pdiv)      /* ptr /= r[B]                           */ \
+    X(bc_pset)      /* ptr = r[B]                            */ \
+    X(bc_pnot)      /* ptr = ~r[B]                           */ \
+    X(bc_pand)      /* ptr &= r[B]                           */ \
+    X(bc_por)       /* ptr |= r[B]                           */ \
+    X(bc_pxor)      /* ptr ^= r[B]                           */ \
+    X(bc_paddi)     /* ptr += B                              */ \
+    X(bc_psubi)     /* ptr -= B                              */ \
+    X(bc_pseti)     /* ptr = B                               */ \
+    X(bc_store)     /* tape[r[B]] = ptr                      */ \
+    X(bc_storei)    /* tape[B] = ptr                         */ \
+    X(bc_lt)        /* r[A] = r[B] < r[C]                    */ \
+    X(bc_gt)        /* r[A] = r[B] > r[C]                    */ \
+    X(bc_le)        /* r[A] = r[B] <= r[C]                   */ \
+    X(bc_ge)        /* r[A] = r[B] >= r[C]                   */ \
+    X(bc_eq)        /* r[A] = r[B] == r[C]                   */ \
+    X(bc_ne)        /* r[A] = r[B] != r[C]                   */ \
+    X(bc_lnot)      /* r[A] = !r[B]                          */ \
+    X(bc_truth)     /* r[A] = r[B] != 0                      */ \
+    X(bc_lxor)      /* r[A] = !r[B] != !r[C]                 */ \
+    X(bc_print)     /* print cell                            */ \
+    X(bc_read)      /* cell = read char                      */ \
+    X(bc_clear)     /* cell = 0 when !A or sign(cell) == A   */ \
+    X(bc_idiom)     /* run loop idiom B                      */
+
+#define BYTECODE_ENUM(op) op,
+enum OpCode : unsigned char { BYTECODE_OPS(BYTECODE_ENUM) bc_numOps };
+#undef BYTECODE_ENUM
+
+struct Instr {
+    OpCode Op;
+    int A, B, C;
+};
+
+class Bytecode {
+public:
+    struct Function {
+        Symbol Id;
+        unsigned int Entry;
+        int Frame;      //number of registers used
+    };
+    std::vector<Instr> Code;
+    std::vector<Location> Locs;         //source location of every instruction, for runtime errors
+    std::vector<Function> Functions;    //Functions[0] is the main code, which ends in bc_halt
+    std::vector<const LoopIdiom*> Idioms;   //owned by the AST
+    int Reach = 0;                      //largest cell offset. engines keep ptr + Reach inside the tape
+
+    static const char *OpName(OpCode op);
+    std::string to_string() const;
+};
+
+//compiles a FlatAST into bytecode. only functions reachable from the main code are compiled
+class BytecodeCompiler {
+    FlatAST *ast;
+    Bytecode *prog;
+    std::vector<int> funcIndex;     //indexed by Symbol, -1 if not referenced yet
+    std::vector<unsigned int> pending;
+    int maxReg;
+    unsigned int emit(OpCode op, Location l, int a = 0, int b = 0, int c = 0);
+    void patch(unsigned int at, unsigned int target) { prog->Code[at].B = (int)target; }
+    unsigned int here() const { return prog->Code.size(); }
+    int function(Symbol id, Location l);
+    int offset(unsigned int n);
+    void compileUnary(unsigned int n, int dst, bool want);
+    void compileBinary(unsigned int n, int dst);     //always leaves the result in dst
+    void compile(unsigned int n, int dst, bool want);
+    void compileFunction(unsigned int index, unsigned int root, OpCode end);
+public:
+    explicit BytecodeCompiler(FlatAST *flat) : ast(flat), prog(nullptr), maxReg(0) {}
+    Bytecode *compile(unsigned int root);
+};
+
+#endif //BRAINPLUS_BYTECODE_H
@@ -0,0 +1,369 @@
+//
+// Created by 7budd on 10/18/2026.
+//
+#include "CEmitter.h"
+#include "CallStack.h"
+
+#include <cctype>
+#include <exception>
+
+//runtime written at the top of every generated file. arithmetic goes through unsigned so overflow wraps
+//like the other engines instead of being undefined behaviour the C optimizer could exploit.
+static const char *runtime = R"(
+static int *tape;
+static size_t size;
+static int ptr;
+static int depth;
+
+static void bp_fail(const char *msg, int at) {
+    fflush(stdout);
+    fprintf(stderr, "RuntimeException: %s at %s\n", msg, bp_locs[at]);
+    exit(6);
+}
+static void bp_range(const char *fmt, int value, int at) {
+    char msg[64];
+    snprintf(msg, sizeof msg, fmt, value);
+    bp_fail(msg, at);
+}
+static int *bp_grow(int addr, int at) {
+    size_t n = size * 2;
+    if (addr < 0) bp_range("Cell %d is out of range", addr, at);
+    if (n < (size_t)addr + 1) n = (size_t)addr + 1;
+    tape = (int *)realloc(tape, n * sizeof(int));
+    if (!tape) bp_fail("Out of memory", at);
+    memset(tape + size, 0, (n - size) * sizeof(int));
+    size = n;
+    return tape + addr;
+}
+static inline int *bp_at(int addr, int at) {
+    return (unsigned int)addr < size ? tape + addr : bp_grow(addr, at);
+}
+static inline int bp_wrap(unsigned int v) { return (int)v; }
+static inline int bp_quot(int x, int v, int at) {
+    if (!v) bp_fail("Division by zero", at);
+    return v == -1 ? bp_wrap(0u - (unsigned int)x) : x / v;
+}
+
+#define BP_CELL_OP(name, expr) static inline int name(int o, int v, int at) { int *c = bp_at(ptr + o, at); return *c = (expr); }
+BP_CELL_OP(bp_add, bp_wrap((unsigned int)*c + (unsigned int)v))
+BP_CELL_OP(bp_sub, bp_wrap((unsigned int)*c - (unsigned int)v))
+BP_CELL_OP(bp_mul, bp_wrap((unsigned int)*c * (unsigned int)v))
+BP_CELL_OP(bp_div, bp_quot(*c, v, at))
+BP_CELL_OP(bp_set, v)
+BP_CELL_OP(bp_not, ~v)
+BP_CELL_OP(bp_and, *c & v)
+BP_CELL_OP(bp_or, *c | v)
+BP_CELL_OP(bp_xor, *c ^ v)
+
+#define BP_PTR_OP(name, expr) static inline int name(int v, int at) { \
+    ptr = (expr); \
+    if (ptr < 0) bp_range("Pointer moved out of range to %d", ptr, at); \
+    return ptr; }
+BP_PTR_OP(bp_padd, bp_wrap((unsigned int)ptr + (unsigned int)v))
+BP_PTR_OP(bp_psub, bp_wrap((unsigned int)ptr - (unsigned int)v))
+BP_PTR_OP(bp_pmul, bp_wrap((unsigned int)ptr * (unsigned int)v))
+BP_PTR_OP(bp_pdiv, bp_quot(ptr, v, at))
+BP_PTR_OP(bp_pset, v)
+BP_PTR_OP(bp_pnot, ~v)
+BP_PTR_OP(bp_pand, ptr & v)
+BP_PTR_OP(bp_por, ptr | v)
+BP_PTR_OP(bp_pxor, ptr ^ v)
+
+#define BP_COMPARE(name, op) static inline int name(int o, int v, int at) { return *bp_at(ptr + o, at) op v; }
+BP_COMPARE(bp_lt, <) BP_COMPARE(bp_gt, >) BP_COMPARE(bp_le, <=)
+BP_COMPARE(bp_ge, >=) BP_COMPARE(bp_eq, ==) BP_COMPARE(bp_ne, !=)
+#define BP_PTR_COMPARE(name, op) static inline int name(int v, int at) { (void)at; return ptr op v; }
+BP_PTR_COMPARE(bp_plt, <) BP_PTR_COMPARE(bp_pgt, >) BP_PTR_COMPARE(bp_ple, <=)
+BP_PTR_COMPARE(bp_pge, >=) BP_PTR_COMPARE(bp_peq, ==) BP_PTR_COMPARE(bp_pne, !=)
+
+static inline int bp_store(int v, int at) { *bp_at(v, at) = ptr; return ptr; }
+static inline int bp_load(int v, int at) { return *bp_at(v, at); }
+static inline int bp_loadup(int o, int v, int at) { return *bp_at(bp_wrap((unsigned int)(ptr + o) + (unsigned int)v), at); }
+static inline int bp_loaddn(int o, int v, int at) { return *bp_at(bp_wrap((unsigned int)(ptr + o) - (unsigned int)v), at); }
+static inline void bp_enter(int at) {
+    if (depth == BP_MAX_DEPTH) bp_fail(BP_OVERFLOW, at);
+    depth++;
+}
+static inline int bp_leave(int v) { depth--; return v; }
+static int bp_print(int o, int at) {
+    int c = *bp_at(ptr + o, at);
+    putchar((unsigned char)c);
+    return c;
+}
+static int bp_read(int o, int at) {
+    int ch;
+    fflush(stdout);
+    ch = getchar();
+    return *bp_at(ptr + o, at) = ch == EOF ? 0 : ch;
+}
+)";
+
+static std::string Literal(int n) {
+    if (n >= 0) return std::to_string(n);
+    return n == -2147483647 - 1 ? "(-2147483647 - 1)" : '(' + std::to_string(n) + ')';
+}
+
+std::string CEmitter::at(Location l) {
+    locs.push_back(l.toString());
+    return std::to_string(locs.size() - 1);
+}
+std::string CEmitter::function(Symbol id, ASTNode *at) {
+    if (!funcs->contains(id))
+        throw std::exception(("UnknownIdentifierException: Unknown function \"" + Interner::Lookup(id) +
+                              "\" at " + at->getLocString()).c_str());
+    if (id >= numbers.size())
+        numbers.resize(id + 1, 0);
+    if (!numbers[id]) {
+        numbers[id] = ++numFunctions;
+        pending.push_back(id);
+    }
+    //the number keeps names unique after unusual characters are replaced. it doesn't depend on symbol ids,
+    //which vary with the order names were first interned
+    std::string name = "bp_f" + std::to_string(numbers[id] - 1) + '_';
+    for (char c : Interner::Lookup(id))
+        name += isalnum((unsigned char)c) ? c : '_';
+    return name;
+}
+//statements that only exist as C statements (loops, ifs) get their own function when used as a value
+std::string CEmitter::hoist(StatementNode *s) {
+    std::string name = "bp_s" + std::to_string(numHoisted++), body;
+    protos += "static int " + name + "(void);\n";
+    block(body, s, 1, true);
+    bodies += "static int " + name + "(void) {\n" + body + "}\n\n";
+    return name + "()";
+}
+
+//loop idioms become small functions running their closed form
+std::string CEmitter::idiom(IdiomNode *s) {
+    const LoopIdiom &li = s->getIdiom();
+    std::string name = "bp_i" + std::to_string(numIdioms++), a = at(s), body;
+    std::string cond = li.Cond == notEqual ? " != 0" : li.Cond == greaterThan ? " > 0" : " < 0";
+    switch (li.Type) {
+        case LoopIdiom::Clear:
+            body = "    int *c = bp_at(ptr, " + a + ");\n"
+                   "    if (*c" + cond + ") *c = 0;\n";
+            break;
+        case LoopIdiom::MulAdd:
+            body = "    int n = *bp_at(ptr, " + a + ");\n"
+                   "    unsigned int times;\n"
+                   "    if (!(n" + cond + ")) return 0;\n";
+            for (auto &low : li.Lows)
+                body += "    if (ptr < " + std::to_string(-low.first) + ") bp_range(\"Pointer moved out of range to %d\", ptr + " +
+                        Literal(low.first) + ", " + at(low.second) + ");\n";
+            body += li.Step < 0 ? "    times = (unsigned int)n;\n" : "    times = 0u - (unsigned int)n;\n";
+            for (auto &add : li.Adds)
+                body += "    { int *c = bp_at(ptr + " + Literal(add.first) + ", " + a + "); *c = bp_wrap((unsigned int)*c + (unsigned int)" +
+                        Literal(add.second) + " * times); }\n";
+            body += "    *bp_at(ptr, " + a + ") = 0;\n";
+            break;
+        case LoopIdiom::Scan:
+            body = "    while (*bp_at(ptr, " + a + ")" + cond + ") bp_padd(" + Literal(li.Step) + ", " +
+                   (li.Step < 0 ? at(li.Lows[0].second) : a) + ");\n";
+            break;
+    }
+    protos += "static int " + name + "(void);\n";
+    bodies += "/* " + li.to_string() + " */\nstatic int " + name + "(void) {\n" + body + "    return 0;\n}\n\n";
+    return name + "()";
+}
+
+std::string CEmitter::expr(StatementNode *s) {
+    if (!s) return "0";
+    switch (s->getType()) {
+        case NodeType::Number: return Literal(((NumberNode*)s)->getNumber());
+        case NodeType::Call:
+            return "(bp_enter(" + at(s) + "), bp_leave(" + function(((CallNode*)s)->getSymbol(), s) + "()))";
+        case NodeType::NullaryOperator:
+            return (((NullaryOperatorNode*)s)->getOp() == Operator::print ? "bp_print(" : "bp_read(") +
+                   Literal(((NullaryOperatorNode*)s)->getOffset()) + ", " + at(s) + ')';
+        case NodeType::UnaryOperator: return unary((UnaryOperatorNode*)s);
+        case NodeType::BinaryOperator: return binary((BinaryOperatorNode*)s);
+        case NodeType::Idiom: return idiom((IdiomNode*)s);
+        case NodeType::Ternary: {
+            auto *t = (IfTernaryNode*)s;
+            return '(' + expr(t->getExpression()) + " ? " + expr(t->getBody()) + " : " + expr(t->getElse()) + ')';
+        }
+        case NodeType::MultiStatement: {
+            auto *m = (MultiStatementNode*)s;
+            std::string str;
+            for (unsigned int i = 0; i < m->getNumStatements(); i++) {
+                NodeType t = m->getStatement(i)->getType();
+                if (t == NodeType::If || t == NodeType::While || t == NodeType::Do || t == NodeType::For)
+                    return hoist(s);
+                str += (i ? ", " : "") + expr(m->getStatement(i));
+            }
+            return str.empty() ? "0" : '(' + str + ')';
+        }
+        default: return hoist(s);
+    }
+}
+std::string CEmitter::unary(UnaryOperatorNode *s) {
+    const char *helper;
+    switch (s->getOp()) {
+        case addition:           helper = "bp_add"; break;
+        case subtraction:        helper = "bp_sub"; break;
+        case multiplication:     helper = "bp_mul"; break;
+        case division:           helper = "bp_div"; break;
+        case assignment:         helper = "bp_set"; break;
+        case bit_not:            helper = "bp_not"; break;
+        case bit_and:            helper = "bp_and"; break;
+        case bit_or:             helper = "bp_or"; break;
+        case bit_xor:            helper = "bp_xor"; break;
+        case ptr_addition:       helper = "bp_padd"; break;
+        case ptr_subtraction:    helper = "bp_psub"; break;
+        case ptr_multiplication: helper = "bp_pmul"; break;
+        case ptr_division:       helper = "bp_pdiv"; break;
+        case ptr_assignment:     helper = "bp_pset"; break;
+        case ptr_not:            helper = "bp_pnot"; break;
+        case ptr_and:            helper = "bp_pand"; break;
+        case ptr_or:             helper = "bp_por"; break;
+        case ptr_xor:            helper = "bp_pxor"; break;
+        case ptr_store:          helper = "bp_store"; break;
+        case ptr_lookup:         helper = "bp_load"; break;
+        case ptr_lookupRelUp:    helper = "bp_loadup"; break;
+        case ptr_lookupRelDown:  helper = "bp_loaddn"; break;
+        case lessThan:           helper = "bp_lt"; break;
+        case greaterThan:        helper = "bp_gt"; break;
+        case lessOrEqual:        helper = "bp_le"; break;
+        case greaterOrEqual:     helper = "bp_ge"; break;
+        case equalTo:            helper = "bp_eq"; break;
+        case notEqual:           helper = "bp_ne"; break;
+        case ptr_lessThan:       helper = "bp_plt"; break;
+        case ptr_greaterThan:    helper = "bp_pgt"; break;
+        case ptr_lessOrEqual:    helper = "bp_ple"; break;
+        case ptr_greaterOrEqual: helper = "bp_pge"; break;
+        case ptr_equalTo:        helper = "bp_peq"; break;
+        case ptr_notEqual:       helper = "bp_pne"; break;
+        case bool_not:           return "(!" + expr(s->getRHS()) + ')';
+        default:
+            throw std::exception(("Unexpected operator " + EnumOps::OpToStr(s->getOp()) + " at " +
+                                  s->getLocString()).c_str());
+    }
+    //helpers that address a cell take its offset from ptr first
+    std::string o = EnumOps::OpUsesCell(s->getOp()) ? Literal(s->getOffset()) + ", " : "";
+    return std::string(helper) + '(' + o + expr(s->getRHS()) + ", " + at(s) + ')';
+}
+//C leaves the evaluation order of a comparison's operands unspecified, and both can move the pointer or write cells.
+//the other engines go left to right, so unless one side is a constant the comparison gets a function reading them in order
+std::string CEmitter::binary(BinaryOperatorNode *s) {
+    std::string l = expr(s->getLHS()), r = expr(s->getRHS()), op;
+    switch (s->getOp()) {
+        case bool_and:       return '(' + l + " && " + r + ')';
+        case bool_or:        return '(' + l + " || " + r + ')';
+        case bool_xor:       l = '!' + l; r = '!' + r; op = " != "; break;
+        case lessThan:       op = " < "; break;
+        case greaterThan:    op = " > "; break;
+        case lessOrEqual:    op = " <= "; break;
+        case greaterOrEqual: op = " >= "; break;
+        case equalTo:        op = " == "; break;
+        case notEqual:       op = " != "; break;
+        default:
+            throw std::exception(("Unexpected operator " + EnumOps::OpToStr(s->getOp()) + " at " +
+                                  s->getLocString()).c_str());
+    }
+    auto constant = [](StatementNode *n) { return !n || n->getType() == NodeType::Number; };
+    if (constant(s->getLHS()) || constant(s->getRHS()))
+        return '(' + l + op + r + ')';
+    std::string name = "bp_c" + std::to_string(numCompares++);
+    protos += "static int " + name + "(void);\n";
+    bodies += "static int " + name + "(void) {\n"
+              "    int l = " + l + ";\n"
+              "    int r = " + r + ";\n"
+              "    return l" + op + "r;\n}\n\n";
+    return name + "()";
+}
+
+void CEmitter::statement(std::string &out, StatementNode *s, int depth, bool ret) {
+    std::string indent(depth * 4, ' ');
+    switch (s->getType()) {
+        case NodeType::MultiStatement: block(out, s, depth, ret); return;
+        case NodeType::While: {
+            auto *w = (DoWhileNode*)s;
+            out += indent + "while (" + expr(w->getExpression()) + ") {\n";
+            block(out, w->getBody(), depth + 1, false);
+            out += indent + "}\n";
+            break;
+        }
+        case NodeType::Do: {
+            auto *d = (DoWhileNode*)s;
+            out += indent + "do {\n";
+            block(out, d->getBody(), depth + 1, false);
+            out += indent + "} while (" + expr(d->getExpression()) + ");\n";
+            break;
+        }
+        case NodeType::If: {
+            auto *i = (IfTernaryNode*)s;
+            out += indent + "if (" + expr(i->getExpression()) + ") {\n";
+            block(out, i->getBody(), depth + 1, false);
+            if (i->getElse()) {
+                out += indent + "} else {\n";
+                block(out, i->getElse(), depth + 1, false);
+            }
+            out += indent + "}\n";
+            break;
+        }
+        case NodeType::For: {
+            auto *f = (ForNode*)s;
+            out += indent + "for (" + (f->getStart() ? expr(f->getStart()) : "") + "; " + expr(f->getExpression()) +
+                   "; " + (f->getStep() ? expr(f->getStep()) : "") + ") {\n";
+            block(out, f->getBody(), depth + 1, false);
+            out += indent + "}\n";
+            break;
+        }
+        default:
+            if (ret) out += indent + "return " + expr(s) + ";\n";
+            else if (s->getType() == NodeType::BinaryOperator || s->getType() == NodeType::Ternary)
+                out += indent + "(void)" + expr(s) + ";\n";
+            else if (s->getType() != NodeType::Number)
+                out += indent + expr(s) + ";\n";
+            return;
+    }
+    //loops and ifs evaluate to 0
+    if (ret) out += indent + "return 0;\n";
+}
+void CEmitter::block(std::string &out, StatementNode *s, int depth, bool ret) {
+    if (s && s->getType() == NodeType::MultiStatement && ((MultiStatementNode*)s)->getNumStatements() > 0) {
+        auto *m = (MultiStatementNode*)s;
+        for (unsigned int i = 0; i < m->getNumStatements(); i++)
+            statement(out, m->getStatement(i), depth, ret && i + 1 == m->getNumStatements());
+    } else if (s && s->getType() != NodeType::MultiStatement)
+        statement(out, s, depth, ret);
+    else if (ret) out += std::string(depth * 4, ' ') + "return 0;\n";
+}
+
+std::string CEmitter::emit(StatementNode *code, const std::string& source) {
+    std::string main;
+    block(main, code, 1, false);
+    while (!pending.empty()) {
+        Symbol id = pending.back();
+        pending.pop_back();
+        std::string name = function(id, code), body;
+        protos += "static int " + name + "(void);\n";
+        block(body, funcs->find(id)->getBody(), 1, true);
+        bodies += "/* " + Interner::Lookup(id) + " */\nstatic int " + name + "(void) {\n" + body + "}\n\n";
+    }
+    locs.emplace_back("?");
+
+    std::string str = "/* generated by brainplus from " + source + "\n"
+                      " * build with: cc -O2 -o program <this file> */\n"
+                      "#include <stdio.h>\n#include <stdlib.h>\n#include <string.h>\n\n"
+                      "static const char *const bp_locs[] = {";
+    for (unsigned int i = 0; i < locs.size(); i++)
+        str += (i % 8 ? " \"" : "\n    \"") + locs[i] + "\",";
+    str += "\n};\n";
+    str += "#define BP_MAX_DEPTH " + std::to_string(CallStack::MaxDepth) + "\n"
+           "#define BP_OVERFLOW \"" + CallStack::Overflow + "\"\n";
+    str += runtime;
+    str += '\n' + protos + '\n' + bodies;
+    str += "int main(void) {\n"
+           "    static char out[1 << 16];\n"
+           "    setvbuf(stdout, out, _IOFBF, sizeof out);\n"
+           "    size = 1024;\n"
+           "    tape = (int *)calloc(size, sizeof(int));\n"
+           "    if (!tape) bp_fail(\"Out of memory\", " + std::to_string(locs.size() - 1) + ");\n" +
+           main +
+           "    fflush(stdout);\n"
+           "    free(tape);\n"
+           "    return 0;\n"
+           "}\n";
+    return str;
+}
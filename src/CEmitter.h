@@ -0,0 +1,42 @@
+//
+// Created by 7budd on 10/18/2026.
+//
+#ifndef BRAINPLUS_CEMITTER_H
+#define BRAINPLUS_CEMITTER_H
+
+#include <string>
+#include <vector>
+#include "ASTNodes.h"
+#include "SymbolTable.h"
+
+//Ahead-of-time backend: translates the statement AST into one self-contained C file
+//functions become static C functions returning the value of their last statement, calls become direct calls,
+//and tape ops become calls to small inline runtime helpers written into the file, so the system compiler
+//can optimize the whole program. only functions reachable from the main code are emitted.
+//runtime errors print the same messages as the Interpreter and exit with code 6.
+class CEmitter {
+    SymbolTable<FunctionNode> *funcs;
+    std::vector<std::string> locs;      //runtime error locations, indexed by the `at` argument of the helpers
+    std::vector<Symbol> pending;
+    std::vector<unsigned int> numbers;  //indexed by Symbol: 1 + order of first use, 0 if not used yet
+    std::string protos, bodies;
+    unsigned int numFunctions, numHoisted, numIdioms, numCompares;
+    std::string at(Location l);
+    std::string at(ASTNode *n) { return at(n->getLoc()); }
+    std::string function(Symbol id, ASTNode *at);
+    std::string hoist(StatementNode *s);
+    std::string idiom(IdiomNode *s);
+    std::string expr(StatementNode *s);
+    std::string unary(UnaryOperatorNode *s);
+    std::string binary(BinaryOperatorNode *s);
+    void statement(std::string &out, StatementNode *s, int depth, bool ret);
+    void block(std::string &out, StatementNode *s, int depth, bool ret);
+public:
+    explicit CEmitter(SymbolTable<FunctionNode> *f) : funcs(f), numFunctions(0), numHoisted(0), numIdioms(0),
+                                                   numCompares(0) {}
+
+    //returns the C source for running `code`; source is only used in the header comment
+    std::string emit(StatementNode *code, const std::string& source);
+};
+
+#endif //BRAINPLUS_CEMITTER_H
@@ -0,0 +1,67 @@
+//
+// Created by 7budd on 10/18/2026.
+//
+#include "CallStack.h"
+
+#include <exception>
+#ifdef _WINDOWS
+#include <windows.h>
+#include <process.h>
+#else
+#include <pthread.h>
+#endif
+
+const char *const CallStack::Overflow = "Call stack overflow";
+
+namespace {
+    struct Job {
+        const std::function<void()> *Task;
+        std::exception_ptr Error;
+    };
+    void runJob(Job *job) {
+        try {
+            (*job->Task)();
+        } catch (...) {
+            job->Error = std::current_exception();
+        }
+    }
+#ifdef _WINDOWS
+    unsigned __stdcall entry(void *job) {
+        runJob((Job*)job);
+        return 0;
+    }
+#else
+    void *entry(void *job) {
+        runJob((Job*)job);
+        return nullptr;
+    }
+#endif
+}
+
+void CallStack::Run(const std::function<void()> &task) {
+    Job job{&task, nullptr};
+#ifdef _WINDOWS
+    //only reserved; pages are committed as the stack grows
+    HANDLE thread = (HANDLE)_beginthreadex(nullptr, (unsigned)StackSize, entry, &job,
+                                           STACK_SIZE_PARAM_IS_A_RESERVATION, nullptr);
+    if (!thread) {
+        task();
+        return;
+    }
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+#else
+    pthread_attr_t attr;
+    pthread_t thread;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, StackSize);
+    int err = pthread_create(&thread, &attr, entry, &job);
+    pthread_attr_destroy(&attr);
+    if (err) {
+        task();
+        return;
+    }
+    pthread_join(thread, nullptr);
+#endif
+    if (job.Error) std::rethrow_exception(job.Error);
+}
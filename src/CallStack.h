@@ -0,0 +1,25 @@
+//
+// Created by 7budd on 10/18/2026.
+//
+#ifndef BRAINPLUS_CALLSTACK_H
+#define BRAINPLUS_CALLSTACK_H
+
+#include <cstddef>
+#include <functional>
+
+//Call nesting limit shared by the engines, and the thread they run programs on
+//every engine (and the emitted C) fails a call that would nest deeper than MaxDepth with the same RuntimeException.
+//the tree interpreter recurses on the native stack several times per call and the JIT keeps return addresses there,
+//so programs run on a thread with a stack sized for that instead of the main thread's (1 MB by default on Windows).
+class CallStack {
+public:
+    static const int MaxDepth = 10000;
+    static const char *const Overflow;      //the error message
+    static const size_t StackSize = 64 << 20;
+
+    //runs `task` on a thread with a StackSize stack and waits for it, rethrowing what it threw.
+    //if no such thread can be started the task runs on the calling thread
+    static void Run(const std::function<void()> &task);
+};
+
+#endif //BRAINPLUS_CALLSTACK_H
@@ -0,0 +1,64 @@
+# Differential check of one program (ctest): every engine must print the same thing and exit with the same code as
+# the unoptimized tree interpreter. runs tree, vm, jit and the emitted C, each with and without --no-opt.
+# cmake -DBRAINPLUS=<brainplus> -DSOURCE=<file.bp> -DWORK=<scratch dir> [-DCC=<c compiler> -DMSVC=ON -DSUFFIX=.exe]
+#       -P DiffEngines.cmake
+get_filename_component(dir "${SOURCE}" DIRECTORY)
+get_filename_component(name "${SOURCE}" NAME)
+get_filename_component(base "${SOURCE}" NAME_WE)
+file(MAKE_DIRECTORY "${WORK}")
+set(empty "${WORK}/${base}.in")
+file(WRITE "${empty}" "")
+
+# runs a command in the program's directory (includes are relative to it) with no input. the timeout is generous
+# because the reference is slow: bench/idioms.bp takes about a minute unoptimized on the tree interpreter
+# sets <out>_stdout, <out>_stderr and <out>_rc, and <out> to all three together
+function(run out)
+    execute_process(COMMAND ${ARGN} WORKING_DIRECTORY "${dir}" INPUT_FILE "${empty}" TIMEOUT 900
+                    OUTPUT_VARIABLE stdout ERROR_VARIABLE stderr RESULT_VARIABLE rc)
+    set(${out}_stdout "${stdout}" PARENT_SCOPE)
+    set(${out}_stderr "${stderr}" PARENT_SCOPE)
+    set(${out}_rc "${rc}" PARENT_SCOPE)
+    set(${out} "${stdout}${stderr}rc=${rc}" PARENT_SCOPE)
+endfunction()
+
+run(expected "${BRAINPLUS}" "${name}" --engine=tree --no-opt)
+set(failed "")
+foreach(opt "" "--no-opt")
+    foreach(engine tree vm jit)
+        if (engine STREQUAL "tree" AND opt STREQUAL "--no-opt")
+            continue()
+        endif()
+        run(actual "${BRAINPLUS}" "${name}" --engine=${engine} ${opt})
+        if (NOT actual STREQUAL expected)
+            list(APPEND failed "${engine} ${opt}")
+            message("${engine} ${opt}:\n${actual}\n")
+        endif()
+    endforeach()
+    if (CC)
+        set(c "${WORK}/${base}${opt}.c")
+        set(exe "${WORK}/${base}${opt}${SUFFIX}")
+        # the front end's messages are printed while emitting, and a program it rejects is never emitted
+        run(actual "${BRAINPLUS}" "${name}" "--emit-c=${c}" ${opt})
+        if (actual_rc EQUAL 0)
+            if (MSVC)
+                execute_process(COMMAND "${CC}" /nologo /O2 "/Fe${exe}" "${c}" WORKING_DIRECTORY "${WORK}"
+                                OUTPUT_QUIET RESULT_VARIABLE rc)
+            else()
+                execute_process(COMMAND "${CC}" -O2 -w -o "${exe}" "${c}" RESULT_VARIABLE rc)
+            endif()
+            if (NOT rc EQUAL 0)
+                message(FATAL_ERROR "${base}: emitted C failed to compile")
+            endif()
+            run(prog "${exe}")
+            set(actual "${actual_stdout}${prog_stdout}${actual_stderr}${prog_stderr}rc=${prog_rc}")
+        endif()
+        if (NOT actual STREQUAL expected)
+            list(APPEND failed "c ${opt}")
+            message("c ${opt}:\n${actual}\n")
+        endif()
+    endif()
+endforeach()
+
+if (failed)
+    message(FATAL_ERROR "${base}: expected\n${expected}\nfrom tree --no-opt, but these differ: ${failed}")
+endif()
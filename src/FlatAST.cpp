@@ -0,0 +1,124 @@
+//
+// Created by 7budd on 10/17/2026.
+//
+#include "FlatAST.h"
+
+const unsigned int FlatAST::None;
+
+unsigned int FlatAST::add(StatementNode *s) {
+    if (!s) return None;
+    StatementNode *kids[4] = {nullptr, nullptr, nullptr, nullptr};
+    unsigned int numKids = 0;
+    int value = 0;
+    Operator op = Operator::null;
+    switch (s->getType()) {
+        case NodeType::MultiStatement: numKids = ((MultiStatementNode*)s)->getNumStatements(); break;
+        case NodeType::Number: value = ((NumberNode*)s)->getNumber(); break;
+        case NodeType::Call: value = (int)((CallNode*)s)->getSymbol(); break;
+        case NodeType::NullaryOperator:
+            op = ((NullaryOperatorNode*)s)->getOp();
+            value = ((NullaryOperatorNode*)s)->getOffset();
+            break;
+        case NodeType::Idiom:
+            value = (int)idioms.size();
+            idioms.push_back(&((IdiomNode*)s)->getIdiom());
+            break;
+        case NodeType::UnaryOperator:
+            op = ((UnaryOperatorNode*)s)->getOp();
+            value = ((UnaryOperatorNode*)s)->getOffset();
+            kids[numKids++] = ((UnaryOperatorNode*)s)->getRHS();
+            break;
+        case NodeType::BinaryOperator:
+            op = ((BinaryOperatorNode*)s)->getOp();
+            kids[numKids++] = ((BinaryOperatorNode*)s)->getLHS();
+            kids[numKids++] = ((BinaryOperatorNode*)s)->getRHS();
+            break;
+        case NodeType::Do:
+        case NodeType::While:
+            kids[numKids++] = ((DoWhileNode*)s)->getExpression();
+            kids[numKids++] = ((DoWhileNode*)s)->getBody();
+            break;
+        case NodeType::If:
+        case NodeType::Ternary:
+            kids[numKids++] = ((IfTernaryNode*)s)->getExpression();
+            kids[numKids++] = ((IfTernaryNode*)s)->getBody();
+            kids[numKids++] = ((IfTernaryNode*)s)->getElse();
+            break;
+        case NodeType::For:
+            kids[numKids++] = ((ForNode*)s)->getStart();
+            kids[numKids++] = ((ForNode*)s)->getExpression();
+            kids[numKids++] = ((ForNode*)s)->getStep();
+            kids[numKids++] = ((ForNode*)s)->getBody();
+            break;
+        default: break;
+    }
+    //the node and its child slots are reserved before the children are flattened (pre-order)
+    unsigned int n = kinds.size(), first = children.size();
+    kinds.push_back((unsigned char)s->getType());
+    ops.push_back((unsigned char)op);
+    values.push_back(value);
+    locs.push_back(s->getLoc());
+    firstChild.push_back(first);
+    numChildren.push_back(numKids);
+    children.resize(first + numKids, None);
+    for (unsigned int i = 0; i < numKids; i++) {
+        unsigned int kid = add(s->getType() == NodeType::MultiStatement ?
+                               ((MultiStatementNode*)s)->getStatement(i) : kids[i]);
+        children[first + i] = kid;
+    }
+    return n;
+}
+unsigned int FlatAST::addFunction(FunctionNode *f) {
+    unsigned int root = add(f->getBody());
+    if (f->getSymbol() >= funcRoots.size())
+        funcRoots.resize(f->getSymbol() + 1, None);
+    funcRoots[f->getSymbol()] = root;
+    return root;
+}
+
+std::string FlatAST::parenthesize(unsigned int n) const {
+    if (n == None) return "";
+    if (getKind(n) == NodeType::Number || (getKind(n) == NodeType::UnaryOperator && EnumOps::OpIsPtrLookup(getOp(n))))
+        return to_string(n);
+    return '(' + to_string(n) + ')';
+}
+std::string FlatAST::to_string(unsigned int n) const {
+    auto block = [this](unsigned int body) { return body != None ? '\n' + to_string(body) + '\n' : std::string(); };
+    switch (getKind(n)) {
+        case NodeType::MultiStatement: {
+            std::string ret;
+            for (unsigned int i = 0; i < getNumChildren(n); i++)
+                ret += '\n' + to_string(getChild(n, i));
+            return ret.empty() ? ret : ret.substr(1);
+        }
+        case NodeType::Number: return std::to_string(getValue(n));
+        case NodeType::Call: return Interner::Lookup((Symbol)getValue(n));
+        case NodeType::NullaryOperator: return NodeOps::OffsetPrefix(getValue(n)) + EnumOps::OpToStr(getOp(n));
+        case NodeType::Idiom: return getIdiom(n)->to_string();
+        case NodeType::UnaryOperator:
+            return NodeOps::OffsetPrefix(getValue(n)) + EnumOps::OpToStr(getOp(n)) + parenthesize(getChild(n, 0));
+        case NodeType::BinaryOperator:
+            return parenthesize(getChild(n, 0)) + EnumOps::OpToStr(getOp(n)) + parenthesize(getChild(n, 1));
+        case NodeType::While:
+            return "while (" + to_string(getChild(n, 0)) + ") {" + block(getChild(n, 1)) + '}';
+        case NodeType::Do:
+            return "do {" + block(getChild(n, 1)) + "} while (" + to_string(getChild(n, 0)) + ')';
+        case NodeType::Ternary:
+            return parenthesize(getChild(n, 0)) + '?' + parenthesize(getChild(n, 1)) + ':' + parenthesize(getChild(n, 2));
+        case NodeType::If: {
+            std::string ret = "if (" + to_string(getChild(n, 0)) + ") {" + block(getChild(n, 1)) + '}';
+            unsigned int elseBody = getChild(n, 2);
+            if (elseBody != None) {
+                ret += " else ";
+                if (getKind(elseBody) != NodeType::If)
+                    ret += "{\n" + to_string(elseBody) + "\n}";
+                else ret += to_string(elseBody);
+            }
+            return ret;
+        }
+        case NodeType::For:
+            return "for (" + (getChild(n, 0) != None ? to_string(getChild(n, 0)) : "") + "; " + to_string(getChild(n, 1)) +
+                   "; " + (getChild(n, 2) != None ? to_string(getChild(n, 2)) : "") + ") {" + block(getChild(n, 3)) + '}';
+        default: return "Statement at " + getLoc(n).toString();
+    }
+}
@@ -0,0 +1,50 @@
+//
+// Created by 7budd on 10/17/2026.
+//
+#ifndef BRAINPLUS_FLATAST_H
+#define BRAINPLUS_FLATAST_H
+
+#include <string>
+#include <vector>
+#include "ASTNodes.h"
+
+//Compact struct-of-arrays form of the statement tree
+//node n is described by its kind, op, value (number, call symbol or cell offset of an op) and location, each stored
+//in its own array.
+//its children are the contiguous index range children[firstChild[n] .. firstChild[n]+numChildren[n]).
+//children have fixed slots per kind (absent optional children are None):
+//  MultiStatement: statements...           UnaryOperator: RHS          BinaryOperator: LHS, RHS
+//  Do/While: expression, body               If/Ternary: expression, body, else
+//  For: start, expression, step, body       Number, Call, NullaryOperator: none
+//  Idiom: none, its value indexes the loop idioms
+class FlatAST {
+    std::vector<unsigned char> kinds, ops;
+    std::vector<int> values;
+    std::vector<Location> locs;
+    std::vector<unsigned int> firstChild, numChildren;
+    std::vector<unsigned int> children;
+    std::vector<unsigned int> funcRoots;    //indexed by Symbol
+    std::vector<const LoopIdiom*> idioms;
+    std::string parenthesize(unsigned int n) const;
+public:
+    static const unsigned int None = ~0u;
+
+    //flattens a tree, returning the index of its root (None if s is null)
+    unsigned int add(StatementNode *s);
+    unsigned int addFunction(FunctionNode *f);
+    unsigned int getFunction(Symbol id) const { return id < funcRoots.size() ? funcRoots[id] : None; }
+
+    unsigned int size() const { return kinds.size(); }
+    NodeType getKind(unsigned int n) const { return (NodeType)kinds[n]; }
+    Operator getOp(unsigned int n) const { return (Operator)ops[n]; }
+    int getValue(unsigned int n) const { return values[n]; }
+    const LoopIdiom *getIdiom(unsigned int n) const { return idioms[values[n]]; }
+    Location getLoc(unsigned int n) const { return locs[n]; }
+    unsigned int getNumChildren(unsigned int n) const { return numChildren[n]; }
+    unsigned int getChild(unsigned int n, unsigned int i) const { return children[firstChild[n] + i]; }
+
+    //same text as the tree's to_string(), rebuilt from the flat arrays
+    std::string to_string(unsigned int n) const;
+};
+
+#endif //BRAINPLUS_FLATAST_H
@@ -0,0 +1,94 @@
+//
+// Created by 7budd on 10/18/2026.
+//
+#include "IO.h"
+
+#include <cerrno>
+#include <fcntl.h>
+#ifdef _WINDOWS
+#include <io.h>
+#define sys_open _open
+#define sys_read _read
+#define sys_write _write
+#define sys_close _close
+#define OPEN_BINARY _O_BINARY
+#else
+#include <unistd.h>
+#define sys_open open
+#define sys_read read
+#define sys_write write
+#define sys_close close
+#define OPEN_BINARY 0
+#endif
+
+const size_t IO::BufferSize;
+
+IO::IO() : out(BufferSize), in(BufferSize), outLen(0), inPos(0), inLen(0), inFd(0), outFd(1),
+           ownIn(false), ownOut(false), writeFailed(false) {}
+IO::~IO() {
+    flush();
+    if (ownIn) sys_close(inFd);
+    if (ownOut) sys_close(outFd);
+}
+
+bool IO::openInput(const std::string& path) {
+    int fd = sys_open(path.c_str(), O_RDONLY | OPEN_BINARY);
+    if (fd < 0) return false;
+    if (ownIn) sys_close(inFd);
+    inFd = fd;
+    ownIn = true;
+    inPos = inLen = 0;
+    return true;
+}
+bool IO::openOutput(const std::string& path) {
+    int fd = sys_open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | OPEN_BINARY, 0644);
+    if (fd < 0) return false;
+    flush();
+    if (ownOut) sys_close(outFd);
+    outFd = fd;
+    ownOut = true;
+    return true;
+}
+void IO::setInput(const std::string& data) {
+    if (ownIn) sys_close(inFd);
+    inFd = -1;
+    ownIn = false;
+    in.assign(data.begin(), data.end());
+    inPos = 0;
+    inLen = in.size();
+}
+void IO::captureOutput() {
+    flush();
+    if (ownOut) sys_close(outFd);
+    outFd = -1;
+    ownOut = false;
+}
+
+void IO::flush() {
+    if (outFd < 0) {
+        captured.append(out.data(), outLen);
+        outLen = 0;
+        return;
+    }
+    //anything the C library buffered for stdout (reports, dumps) goes first
+    if (outFd == 1) fflush(stdout);
+    for (size_t done = 0; done < outLen && !writeFailed; ) {
+        int n = (int)sys_write(outFd, out.data() + done, (unsigned int)(outLen - done));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) writeFailed = true;
+        else done += n;
+    }
+    outLen = 0;
+}
+bool IO::fill() {
+    //a program waiting on input has to show its prompt first
+    flush();
+    if (inFd < 0) return false;
+    if (in.size() < BufferSize) in.resize(BufferSize);
+    int n;
+    do n = (int)sys_read(inFd, in.data(), (unsigned int)in.size());
+    while (n < 0 && errno == EINTR);
+    inPos = 0;
+    inLen = n > 0 ? n : 0;
+    return inLen > 0;
+}
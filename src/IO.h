@@ -0,0 +1,52 @@
+//
+// Created by 7budd on 10/18/2026.
+//
+#ifndef BRAINPLUS_IO_H
+#define BRAINPLUS_IO_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+//Buffered character I/O behind . and , for every engine
+//output collects in a large buffer that is written out in one call when it fills, when , needs more input,
+//on flush() and when the IO is destroyed. input is read in bulk, as much as is available per call, so
+//interactive input still works line by line.
+//by default both ends are stdin/stdout; either can be redirected to a file, or to memory for batch runs.
+class IO {
+    std::vector<char> out, in;
+    size_t outLen, inPos, inLen;
+    int inFd, outFd;            //-1 for memory
+    bool ownIn, ownOut;         //opened here, so closed here
+    bool writeFailed;
+    std::string captured;       //memory output
+    bool fill();
+public:
+    static const size_t BufferSize = 1 << 16;
+
+    IO();
+    ~IO();
+    IO(const IO&) = delete;
+    IO &operator=(const IO&) = delete;
+
+    //return false if the file can't be opened, leaving the current source/destination in place
+    bool openInput(const std::string& path);
+    bool openOutput(const std::string& path);
+    //reads come from `data`, then EOF
+    void setInput(const std::string& data);
+    //writes are kept in memory and returned by getOutput
+    void captureOutput();
+    const std::string &getOutput() { flush(); return captured; }
+
+    void put(int c) {
+        if (outLen == out.size()) flush();
+        out[outLen++] = (char)c;
+    }
+    //the next input byte, or EOF
+    int get() { return inPos < inLen || fill() ? (unsigned char)in[inPos++] : EOF; }
+    void flush();
+    //true once a write has failed; the output from then on is dropped
+    bool failed() const { return writeFailed; }
+};
+
+#endif //BRAINPLUS_IO_H
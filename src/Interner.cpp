@@ -0,0 +1,49 @@
+//
+// Created by 7budd on 10/17/2026.
+//
+#include "Interner.h"
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+    //map keys are never moved, so the id -> string table can point straight at them
+    std::unordered_map<std::string, Symbol> &ids() {
+        static std::unordered_map<std::string, Symbol> table;
+        return table;
+    }
+    std::vector<const std::string*> &strings() {
+        static std::vector<const std::string*> table;
+        return table;
+    }
+    std::mutex &lock() {
+        static std::mutex m;
+        return m;
+    }
+}
+
+Symbol Interner::Intern(const std::string& str) {
+    //lexers on other threads intern the same names over and over, so each thread remembers the ones it has seen
+    thread_local std::unordered_map<std::string, Symbol> seen;
+    auto it = seen.find(str);
+    if (it != seen.end()) return it->second;
+    Symbol id;
+    {
+        std::lock_guard<std::mutex> l(lock());
+        auto res = ids().emplace(str, strings().size());
+        if (res.second)
+            strings().push_back(&res.first->first);
+        id = res.first->second;
+    }
+    seen.emplace(str, id);
+    return id;
+}
+const std::string &Interner::Lookup(Symbol id) {
+    std::lock_guard<std::mutex> l(lock());
+    return *strings().at(id);
+}
+unsigned int Interner::Size() {
+    std::lock_guard<std::mutex> l(lock());
+    return strings().size();
+}
@@ -0,0 +1,23 @@
+//
+// Created by 7budd on 10/17/2026.
+//
+#ifndef BRAINPLUS_INTERNER_H
+#define BRAINPLUS_INTERNER_H
+
+#include <string>
+
+//handle to an interned string
+typedef unsigned int Symbol;
+
+//string interning table shared by every Lexer, Parser and AST node
+//each distinct identifier, define name, function name and file name gets a small integer handle,
+//so tokens and nodes stay small and name comparisons are O(1)
+//safe to use from several threads; ids then depend on the order threads first see each name
+class Interner {
+public:
+    static Symbol Intern(const std::string& str);
+    static const std::string &Lookup(Symbol id);
+    static unsigned int Size();
+};
+
+#endif //BRAINPLUS_INTERNER_H
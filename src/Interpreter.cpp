@@ -0,0 +1,184 @@
+//
+// Created by 7budd on 10/17/2026.
+//
+#include "Interpreter.h"
+#include "Arith.h"
+#include "CallStack.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+#include <new>
+
+static void runtimeError(const std::string& msg, ASTNode *at) {
+    throw std::exception(("RuntimeException: " + msg + " at " + at->getLocString()).c_str());
+}
+
+int &Interpreter::cell(int addr, ASTNode *at) {
+    if (addr < 0)
+        runtimeError("Cell " + std::to_string(addr) + " is out of range", at);
+    int *c = tape.cell(addr);
+    if (!c) runtimeError("Out of memory", at);
+    return *c;
+}
+
+int Interpreter::run(StatementNode *code) {
+    int ret = code ? eval(code) : 0;
+    io->flush();
+    return ret;
+}
+int Interpreter::eval(StatementNode *s) {
+    switch (s->getType()) {
+        case NodeType::MultiStatement: {
+            auto *m = (MultiStatementNode*)s;
+            int ret = 0;
+            for (unsigned int i = 0; i < m->getNumStatements(); i++)
+                ret = eval(m->getStatement(i));
+            return ret;
+        }
+        case NodeType::Number: return ((NumberNode*)s)->getNumber();
+        case NodeType::Call: {
+            FunctionNode *f = funcs->find(((CallNode*)s)->getSymbol());
+            if (!f) runtimeError("Unknown function \"" + ((CallNode*)s)->getId() + '"', s);
+            if (depth == CallStack::MaxDepth) runtimeError(CallStack::Overflow, s);
+            depth++;
+            int ret = f->getBody() ? eval(f->getBody()) : 0;
+            depth--;
+            return ret;
+        }
+        case NodeType::NullaryOperator: {
+            int &c = cell(ptr + ((NullaryOperatorNode*)s)->getOffset(), s);
+            if (((NullaryOperatorNode*)s)->getOp() == Operator::print)
+                io->put((unsigned char)c);
+            else {
+                int ch = io->get();
+                c = ch == EOF ? 0 : ch;
+            }
+            return c;
+        }
+        case NodeType::UnaryOperator: return evalUnary((UnaryOperatorNode*)s);
+        case NodeType::BinaryOperator: return evalBinary((BinaryOperatorNode*)s);
+        case NodeType::While: {
+            auto *w = (DoWhileNode*)s;
+            while (eval(w->getExpression()))
+                if (w->getBody()) eval(w->getBody());
+            return 0;
+        }
+        case NodeType::Do: {
+            auto *d = (DoWhileNode*)s;
+            do if (d->getBody()) eval(d->getBody());
+            while (eval(d->getExpression()));
+            return 0;
+        }
+        case NodeType::If: {
+            auto *i = (IfTernaryNode*)s;
+            StatementNode *branch = eval(i->getExpression()) ? i->getBody() : i->getElse();
+            if (branch) eval(branch);
+            return 0;
+        }
+        case NodeType::Ternary: {
+            auto *t = (IfTernaryNode*)s;
+            return eval(t->getExpression()) ? eval(t->getBody()) : eval(t->getElse());
+        }
+        case NodeType::For: {
+            auto *f = (ForNode*)s;
+            if (f->getStart()) eval(f->getStart());
+            while (eval(f->getExpression())) {
+                if (f->getBody()) eval(f->getBody());
+                if (f->getStep()) eval(f->getStep());
+            }
+            return 0;
+        }
+        case NodeType::Idiom: {
+            const Location *err;
+            try {
+                err = ((IdiomNode*)s)->getIdiom().run(tape, ptr);
+            } catch (std::bad_alloc&) {
+                runtimeError("Out of memory", s);
+            }
+            if (err)
+                throw std::exception(("RuntimeException: Pointer moved out of range to " + std::to_string(ptr) +
+                                      " at " + err->toString()).c_str());
+            return 0;
+        }
+        default:
+            runtimeError("Cannot execute " + s->to_string(), s);
+            return 0;
+    }
+}
+int Interpreter::evalUnary(UnaryOperatorNode *s) {
+    int v = s->getRHS() ? eval(s->getRHS()) : 0, addr = ptr + s->getOffset();
+    switch (s->getOp()) {
+        //value operators
+        case addition:       { int &c = cell(addr, s); return c = Arith::Add(c, v); }
+        case subtraction:    { int &c = cell(addr, s); return c = Arith::Sub(c, v); }
+        case multiplication: { int &c = cell(addr, s); return c = Arith::Mul(c, v); }
+        case division: {
+            if (v == 0) runtimeError("Division by zero", s);
+            int &c = cell(addr, s);
+            return c = Arith::Quot(c, v);
+        }
+        case assignment:     return cell(addr, s) = v;
+        case bit_not:        return cell(addr, s) = ~v;
+        case bit_and:        return cell(addr, s) &= v;
+        case bit_or:         return cell(addr, s) |= v;
+        case bit_xor:        return cell(addr, s) ^= v;
+        //ptr operators
+        case ptr_addition:       ptr = Arith::Add(ptr, v); break;
+        case ptr_subtraction:    ptr = Arith::Sub(ptr, v); break;
+        case ptr_multiplication: ptr = Arith::Mul(ptr, v); break;
+        case ptr_division:
+            if (v == 0) runtimeError("Division by zero", s);
+            ptr = Arith::Quot(ptr, v);
+            break;
+        case ptr_assignment: ptr = v; break;
+        case ptr_not:        ptr = ~v; break;
+        case ptr_and:        ptr &= v; break;
+        case ptr_or:         ptr |= v; break;
+        case ptr_xor:        ptr ^= v; break;
+        case ptr_store:      cell(v, s) = ptr; return ptr;
+        //lookups
+        case ptr_lookup:        return cell(v, s);
+        case ptr_lookupRelUp:   return cell(addr + v, s);
+        case ptr_lookupRelDown: return cell(addr - v, s);
+        //comparisons
+        case lessThan:       return cell(addr, s) < v;
+        case greaterThan:    return cell(addr, s) > v;
+        case lessOrEqual:    return cell(addr, s) <= v;
+        case greaterOrEqual: return cell(addr, s) >= v;
+        case equalTo:        return cell(addr, s) == v;
+        case notEqual:       return cell(addr, s) != v;
+        case ptr_lessThan:       return ptr < v;
+        case ptr_greaterThan:    return ptr > v;
+        case ptr_lessOrEqual:    return ptr <= v;
+        case ptr_greaterOrEqual: return ptr >= v;
+        case ptr_equalTo:        return ptr == v;
+        case ptr_notEqual:       return ptr != v;
+        case bool_not:       return !v;
+        default:
+            runtimeError("Unexpected operator " + EnumOps::OpToStr(s->getOp()), s);
+    }
+    if (ptr < 0) runtimeError("Pointer moved out of range to " + std::to_string(ptr), s);
+    return ptr;
+}
+int Interpreter::evalBinary(BinaryOperatorNode *s) {
+    int l = eval(s->getLHS());
+    switch (s->getOp()) {
+        case bool_and: return l && eval(s->getRHS());
+        case bool_or:  return l || eval(s->getRHS());
+        default: break;
+    }
+    int r = eval(s->getRHS());
+    switch (s->getOp()) {
+        case lessThan:       return l < r;
+        case greaterThan:    return l > r;
+        case lessOrEqual:    return l <= r;
+        case greaterOrEqual: return l >= r;
+        case equalTo:        return l == r;
+        case notEqual:       return l != r;
+        case bool_xor:       return !l != !r;
+        default:
+            runtimeError("Unexpected operator " + EnumOps::OpToStr(s->getOp()), s);
+            return 0;
+    }
+}
@@ -0,0 +1,41 @@
+//
+// Created by 7budd on 10/17/2026.
+//
+#ifndef BRAINPLUS_INTERPRETER_H
+#define BRAINPLUS_INTERPRETER_H
+
+#include "ASTNodes.h"
+#include "IO.h"
+#include "SymbolTable.h"
+#include "Tape.h"
+
+//Tree-walking interpreter over the statement AST
+//the machine is a tape of int cells and a pointer into it. every statement evaluates to a number:
+//  value ops (+ - * / = ! & | ^) update the current cell and return it
+//  ptr ops (@+ @- @* @/ @= @! @& @| @^) update the pointer and return it
+//  # n stores the pointer in cell n and returns it
+//  lookups (@ n, @# n, @## n) return the cell at n, ptr+n or ptr-n
+//  comparisons and boolean ops return 0 or 1, loops return 0
+//  . and , print/read the current cell as an ASCII character and return it
+//ops given a cell offset by the Optimizer use the cell at ptr + offset as their current cell.
+//calls recurse on the native stack, so programs should be run through CallStack::Run.
+class Interpreter {
+    Tape tape;
+    int ptr;
+    int depth;      //calls in progress
+    SymbolTable<FunctionNode> *funcs;
+    IO *io;
+    int &cell(int addr, ASTNode *at);
+    int eval(StatementNode *s);
+    int evalUnary(UnaryOperatorNode *s);
+    int evalBinary(BinaryOperatorNode *s);
+public:
+    Interpreter(SymbolTable<FunctionNode> *f, IO *io, Tape::Mode m = Tape::Dense) : tape(m), ptr(0), depth(0), funcs(f), io(io) {}
+
+    int run(StatementNode *code);
+    int getPtr() const { return ptr; }
+    int getCell(int addr) const { return tape.get(addr); }
+    const Tape &getTape() const { return tape; }
+};
+
+#endif //BRAINPLUS_INTERPRETER_H
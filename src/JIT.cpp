@@ -0,0 +1,552 @@
+//
+// Created by 7budd on 10/18/2026.
+//
+#include "JIT.h"
+#include "CallStack.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <initializer_list>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define JIT_X64
+#ifdef _WINDOWS
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+#endif
+
+#ifdef JIT_X64
+namespace {
+
+//state shared between the generated code and the helpers, addressed from rbp
+struct Context {
+    int *Tape;                  //r12 while running
+    int Limit;                  //r15d, tape size - Reach. ptr and computed addresses below it need no check
+    int Reach;                  //largest cell offset of the program
+    int Ptr;                    //r13d, and r14 = Tape + Ptr
+    int *Regs;                  //frame base, rbx
+    void *Stack;                //rsp on entry, restored when bailing out on an error
+    int Depth;
+    int Error;
+    int ErrorPc;
+    int Value;                  //offending address for range errors
+    const Location *ErrorLoc;   //set instead of ErrorPc by loop idioms
+    ::Tape *Store;
+    IO *Io;
+};
+enum Error { e_none, e_cell, e_ptr, e_div, e_depth, e_memory, e_idiom };
+
+//helpers called from generated code. they must not throw through it
+void setTape(Context *c) {
+    size_t size = c->Store->getSize();
+    c->Tape = c->Store->data();
+    c->Limit = size > (size_t)c->Reach ? (int)std::min<size_t>(size - c->Reach, 0x7fffffff) : 0;
+}
+int *growTape(Context *c, int addr, int isPtr) {
+    if (addr < 0) {
+        c->Error = isPtr ? e_ptr : e_cell;
+        c->Value = addr;
+        return nullptr;
+    }
+    //Limit can't pass INT_MAX, so the last cells of a full-size tape are out of reach too
+    if (!c->Store->grow((size_t)addr + c->Reach) || (size_t)addr + c->Reach >= 0x7fffffff) {
+        c->Error = e_memory;
+        return nullptr;
+    }
+    setTape(c);
+    return c->Tape;
+}
+int runIdiom(Context *c, int ptr, const LoopIdiom *idiom) {
+    const Location *err;
+    try {
+        err = idiom->run(*c->Store, ptr);
+    } catch (...) {
+        c->Error = e_memory;
+        return ptr;
+    }
+    setTape(c);
+    if (err) {
+        c->Error = e_idiom;
+        c->Value = ptr;
+        c->ErrorLoc = err;
+    }
+    return ptr;
+}
+void printCell(Context *c, int ch) {
+    c->Io->put((unsigned char)ch);
+}
+int readCell(Context *c) {
+    int ch = c->Io->get();
+    return ch == EOF ? 0 : ch;
+}
+
+enum Reg { rax, rcx, rdx, rbx, rsp, rbp, rsi, rdi, r8, r9, r10, r11, r12, r13, r14, r15 };
+enum Cond { c_b = 0x2, c_ae = 0x3, c_e = 0x4, c_ne = 0x5, c_a = 0x7, c_l = 0xC, c_ge = 0xD, c_le = 0xE, c_g = 0xF };
+#ifdef _WIN64
+const Reg arg0 = rcx, arg1 = rdx, arg2 = r8;
+#else
+const Reg arg0 = rdi, arg1 = rsi, arg2 = rdx;
+#endif
+#define CTX(field) (int)offsetof(Context, field)
+
+//just enough of an x86-64 assembler for the instructions the compiler below needs
+class Assembler {
+public:
+    std::vector<unsigned char> buf;
+
+    size_t here() const { return buf.size(); }
+    void byte(int b) { buf.push_back((unsigned char)b); }
+    void dword(int v) { for (int i = 0; i < 4; i++) byte(v >> i * 8); }
+    void qword(long long v) { for (int i = 0; i < 8; i++) byte((int)(v >> i * 8)); }
+    void bytes(std::initializer_list<int> op) { for (int b : op) byte(b); }
+    void rex(bool w, int reg, int index, int base) {
+        int r = 0x40 | w << 3 | (reg >> 3) << 2 | (index >> 3) << 1 | base >> 3;
+        if (r != 0x40) byte(r);
+    }
+    //op reg, [base + disp]
+    void mem(bool w, std::initializer_list<int> op, int reg, Reg base, int disp) {
+        rex(w, reg, 0, base);
+        bytes(op);
+        int mod = disp == 0 && (base & 7) != rbp ? 0 : disp >= -128 && disp < 128 ? 1 : 2;
+        byte(mod << 6 | (reg & 7) << 3 | (base & 7));
+        if ((base & 7) == rsp) byte(0x24);
+        if (mod == 1) byte(disp);
+        else if (mod == 2) dword(disp);
+    }
+    //op reg, [base + index*4]
+    void idx(bool w, std::initializer_list<int> op, int reg, Reg base, Reg index) {
+        rex(w, reg, index, base);
+        bytes(op);
+        int mod = (base & 7) == rbp ? 1 : 0;
+        byte(mod << 6 | (reg & 7) << 3 | rsp);
+        byte(2 << 6 | (index & 7) << 3 | (base & 7));
+        if (mod) byte(0);
+    }
+    //op rm, reg (or op rm with an opcode extension in reg)
+    void rr(bool w, std::initializer_list<int> op, int reg, Reg rm) {
+        rex(w, reg, 0, rm);
+        bytes(op);
+        byte(0xC0 | (reg & 7) << 3 | (rm & 7));
+    }
+    void movImm(Reg r, int imm) {
+        rex(false, 0, 0, r);
+        byte(0xB8 + (r & 7));
+        dword(imm);
+    }
+    void movImm64(Reg r, const void *imm) {
+        rex(true, 0, 0, r);
+        byte(0xB8 + (r & 7));
+        qword((long long)(size_t)imm);
+    }
+    void push(Reg r) { rex(false, 0, 0, r); byte(0x50 + (r & 7)); }
+    void pop(Reg r) { rex(false, 0, 0, r); byte(0x58 + (r & 7)); }
+    //jumps return the position of their rel32 for bind/patch
+    size_t jmp() { byte(0xE9); dword(0); return here() - 4; }
+    size_t jcc(Cond c) { bytes({0x0F, 0x80 | c}); dword(0); return here() - 4; }
+    size_t call() { byte(0xE8); dword(0); return here() - 4; }
+    void patch(size_t at, size_t target) {
+        int rel = (int)(target - (at + 4));
+        memcpy(&buf[at], &rel, 4);
+    }
+    void bind(size_t at) { patch(at, here()); }
+    void callAbs(const void *fn) {
+#ifdef _WIN64
+        bytes({0x48, 0x83, 0xEC, 0x20});    //shadow space
+#endif
+        bytes({0x48, 0xB8});
+        qword((long long)(size_t)fn);
+        bytes({0xFF, 0xD0});
+#ifdef _WIN64
+        bytes({0x48, 0x83, 0xC4, 0x20});
+#endif
+    }
+};
+
+class X64Compiler {
+    const Bytecode *prog;
+    Assembler a;
+    std::vector<size_t> native;                             //native offset of every instruction
+    std::vector<std::pair<size_t, unsigned int>> jumps;     //rel32 to patch with native[pc]
+    std::vector<size_t> errors, exits;
+    unsigned int pc;
+
+    static int R(int i) { return i * 4; }
+    void loadReg(Reg r, int i) { a.mem(false, {0x8B}, r, rbx, R(i)); }
+    void storeReg(int i, Reg r) { a.mem(false, {0x89}, r, rbx, R(i)); }
+    void setCtx(int field, int v) { a.mem(false, {0xC7}, 0, rbp, field); a.dword(v); }
+    //the tape grew or a helper ran: reload its base and limit and recompute the cell pointer
+    void reloadTape() {
+        a.mem(true, {0x8B}, r12, rbp, CTX(Tape));
+        a.mem(false, {0x8B}, r15, rbp, CTX(Limit));
+        a.idx(true, {0x8D}, r14, r12, r13);
+    }
+    void fail(Cond c, int error) {
+        size_t ok = a.jcc((Cond)(c ^ 1));
+        setCtx(CTX(Error), error);
+        setCtx(CTX(ErrorPc), (int)pc);
+        errors.push_back(a.jmp());
+        a.bind(ok);
+    }
+    //grows the tape until the int in `addr` is in range. the fast path is one compare and branch
+    void grow(Reg addr, bool isPtr, bool keep) {
+        size_t retry = a.here();
+        a.rr(false, {0x39}, r15, addr);
+        size_t ok = a.jcc(c_b);
+        setCtx(CTX(ErrorPc), (int)pc);
+        if (keep) a.mem(false, {0x89}, addr, rbp, CTX(Value));
+        a.rr(true, {0x89}, rbp, arg0);
+        a.rr(false, {0x89}, addr, arg1);
+        a.movImm(arg2, isPtr);
+        a.callAbs((const void*)&growTape);
+        a.rr(true, {0x85}, rax, rax);
+        errors.push_back(a.jcc(c_e));
+        reloadTape();
+        if (keep) a.mem(false, {0x8B}, addr, rbp, CTX(Value));
+        a.patch(a.jmp(), retry);
+        a.bind(ok);
+    }
+    //eax holds a computed address
+    void checked() { grow(rax, false, true); }
+    void moved() {
+        grow(r13, true, false);
+        a.idx(true, {0x8D}, r14, r12, r13);
+    }
+    void load(int dst) {
+        checked();
+        a.idx(false, {0x8B}, rax, r12, rax);
+        storeReg(dst, rax);
+    }
+    void compare(const Instr &i, Cond c) {
+        loadReg(rax, i.B);
+        a.mem(false, {0x3B}, rax, rbx, R(i.C));
+        a.bytes({0x0F, 0x90 | c, 0xC0, 0x0F, 0xB6, 0xC0});     //setcc al; movzx eax, al
+        storeReg(i.A, rax);
+    }
+    void truth(const Instr &i, Cond c) {
+        a.mem(false, {0x83}, 7, rbx, R(i.B));
+        a.byte(0);
+        a.bytes({0x0F, 0x90 | c, 0xC0, 0x0F, 0xB6, 0xC0});
+        storeReg(i.A, rax);
+    }
+    //cell or ptr /= r[B]. INT_MIN / -1 is negated instead of trapping
+    void divide(int b, bool isPtr, int cell = 0) {
+        loadReg(rcx, b);
+        a.rr(false, {0x85}, rcx, rcx);
+        fail(c_e, e_div);
+        a.bytes({0x83, 0xF9, 0xFF});                            //cmp ecx, -1
+        size_t div = a.jcc(c_ne);
+        if (isPtr) a.rr(false, {0xF7}, 3, r13);
+        else a.mem(false, {0xF7}, 3, r14, cell);
+        size_t done = a.jmp();
+        a.bind(div);
+        if (isPtr) a.rr(false, {0x89}, r13, rax);
+        else a.mem(false, {0x8B}, rax, r14, cell);
+        a.bytes({0x99, 0xF7, 0xF9});                            //cdq; idiv ecx
+        if (isPtr) a.rr(false, {0x89}, rax, r13);
+        else a.mem(false, {0x89}, rax, r14, cell);
+        a.bind(done);
+    }
+    void cellOp(int op, int b, int cell) {
+        loadReg(rax, b);
+        a.mem(false, {op}, rax, r14, cell);
+    }
+    void ptrOp(std::initializer_list<int> op, int b) {
+        a.mem(false, op, r13, rbx, R(b));
+        moved();
+    }
+    void ptrImm(int ext, int imm) {
+        a.rr(false, {0x81}, ext, r13);
+        a.dword(imm);
+        moved();
+    }
+    void instr(const Instr &i);
+public:
+    explicit X64Compiler(const Bytecode *p) : prog(p), pc(0) {}
+    std::vector<unsigned char> &compile();
+};
+
+void X64Compiler::instr(const Instr &i) {
+    int cell = i.C * 4;     //displacement of the op's cell from r14
+    switch (i.Op) {
+        case bc_halt:
+            a.mem(false, {0x89}, r13, rbp, CTX(Ptr));
+            loadReg(rax, 0);
+            exits.push_back(a.jmp());
+            break;
+        case bc_ret: a.byte(0xC3); break;
+        case bc_call:
+            //the native stack holds the return address and the caller's frame base.
+            //the register file is sized for the deepest calls allowed, so only the depth is checked
+            a.push(rbx);
+            a.mem(true, {0x8D}, rbx, rbx, R(i.A));
+            a.mem(false, {0x83}, 0, rbp, CTX(Depth));
+            a.byte(1);
+            a.mem(false, {0x81}, 7, rbp, CTX(Depth));
+            a.dword(CallStack::MaxDepth);
+            fail(c_g, e_depth);
+            jumps.emplace_back(a.call(), prog->Functions[i.B].Entry);
+            a.mem(false, {0x83}, 5, rbp, CTX(Depth));
+            a.byte(1);
+            a.pop(rbx);
+            break;
+        case bc_jmp: jumps.emplace_back(a.jmp(), i.B); break;
+        case bc_jz:
+        case bc_jnz:
+            a.mem(false, {0x83}, 7, rbx, R(i.A));
+            a.byte(0);
+            jumps.emplace_back(a.jcc(i.Op == bc_jz ? c_e : c_ne), i.B);
+            break;
+        case bc_loadk: a.mem(false, {0xC7}, 0, rbx, R(i.A)); a.dword(i.B); break;
+        case bc_cell: a.mem(false, {0x8B}, rax, r14, cell); storeReg(i.A, rax); break;
+        case bc_getptr: storeReg(i.A, r13); break;
+        case bc_load: loadReg(rax, i.B); load(i.A); break;
+        case bc_loadi: a.movImm(rax, i.B); load(i.A); break;
+        case bc_loadup: a.mem(false, {0x8D}, rax, r13, i.C); a.mem(false, {0x03}, rax, rbx, R(i.B)); load(i.A); break;
+        case bc_loadupi: a.mem(false, {0x8D}, rax, r13, i.B); load(i.A); break;
+        case bc_loaddn: a.mem(false, {0x8D}, rax, r13, i.C); a.mem(false, {0x2B}, rax, rbx, R(i.B)); load(i.A); break;
+        case bc_loaddni: a.mem(false, {0x8D}, rax, r13, -i.B); load(i.A); break;
+        case bc_add: cellOp(0x01, i.B, cell); break;
+        case bc_sub: cellOp(0x29, i.B, cell); break;
+        case bc_and: cellOp(0x21, i.B, cell); break;
+        case bc_or: cellOp(0x09, i.B, cell); break;
+        case bc_xor: cellOp(0x31, i.B, cell); break;
+        case bc_mul:
+            a.mem(false, {0x8B}, rax, r14, cell);
+            a.mem(false, {0x0F, 0xAF}, rax, rbx, R(i.B));
+            a.mem(false, {0x89}, rax, r14, cell);
+            break;
+        case bc_div: divide(i.B, false, cell); break;
+        case bc_set: loadReg(rax, i.B); a.mem(false, {0x89}, rax, r14, cell); break;
+        case bc_not:
+            loadReg(rax, i.B);
+            a.rr(false, {0xF7}, 2, rax);
+            a.mem(false, {0x89}, rax, r14, cell);
+            break;
+        case bc_addi: a.mem(false, {0x81}, 0, r14, cell); a.dword(i.B); break;
+        case bc_subi: a.mem(false, {0x81}, 5, r14, cell); a.dword(i.B); break;
+        case bc_muli:
+            a.mem(false, {0x69}, rax, r14, cell);
+            a.dword(i.B);
+            a.mem(false, {0x89}, rax, r14, cell);
+            break;
+        case bc_seti: a.mem(false, {0xC7}, 0, r14, cell); a.dword(i.B); break;
+        case bc_padd: ptrOp({0x03}, i.B); break;
+        case bc_psub: ptrOp({0x2B}, i.B); break;
+        case bc_pmul: ptrOp({0x0F, 0xAF}, i.B); break;
+        case bc_pdiv: divide(i.B, true); moved(); break;
+        case bc_pset: ptrOp({0x8B}, i.B); break;
+        case bc_pnot:
+            loadReg(r13, i.B);
+            a.rr(false, {0xF7}, 2, r13);
+            moved();
+            break;
+        case bc_pand: ptrOp({0x23}, i.B); break;
+        case bc_por: ptrOp({0x0B}, i.B); break;
+        case bc_pxor: ptrOp({0x33}, i.B); break;
+        case bc_paddi: ptrImm(0, i.B); break;
+        case bc_psubi: ptrImm(5, i.B); break;
+        case bc_pseti: a.movImm(r13, i.B); moved(); break;
+        case bc_store:
+        case bc_storei:
+            if (i.Op == bc_store) loadReg(rax, i.B);
+            else a.movImm(rax, i.B);
+            checked();
+            a.idx(false, {0x89}, r13, r12, rax);
+            break;
+        case bc_lt: compare(i, c_l); break;
+        case bc_gt: compare(i, c_g); break;
+        case bc_le: compare(i, c_le); break;
+        case bc_ge: compare(i, c_ge); break;
+        case bc_eq: compare(i, c_e); break;
+        case bc_ne: compare(i, c_ne); break;
+        case bc_lnot: truth(i, c_e); break;
+        case bc_truth: truth(i, c_ne); break;
+        case bc_lxor:
+            a.mem(false, {0x83}, 7, rbx, R(i.B));
+            a.byte(0);
+            a.bytes({0x0F, 0x94, 0xC0});                        //sete al
+            a.mem(false, {0x83}, 7, rbx, R(i.C));
+            a.byte(0);
+            a.bytes({0x0F, 0x94, 0xC1, 0x30, 0xC8});            //sete cl; xor al, cl
+            a.bytes({0x0F, 0xB6, 0xC0});
+            storeReg(i.A, rax);
+            break;
+        case bc_print:
+            a.rr(true, {0x89}, rbp, arg0);
+            a.mem(false, {0x8B}, arg1, r14, cell);
+            a.callAbs((const void*)&printCell);
+            break;
+        case bc_read:
+            a.rr(true, {0x89}, rbp, arg0);
+            a.callAbs((const void*)&readCell);
+            a.mem(false, {0x89}, rax, r14, cell);
+            break;
+        case bc_clear: {
+            size_t skip = 0;
+            if (i.A) {
+                a.mem(false, {0x83}, 7, r14, 0);
+                a.byte(0);
+                skip = a.jcc(i.A > 0 ? c_le : c_ge);
+            }
+            a.mem(false, {0xC7}, 0, r14, 0);
+            a.dword(0);
+            if (i.A) a.bind(skip);
+            break;
+        }
+        case bc_idiom:
+            a.rr(true, {0x89}, rbp, arg0);
+            a.rr(false, {0x89}, r13, arg1);
+            a.movImm64(arg2, prog->Idioms[i.B]);
+            a.callAbs((const void*)&runIdiom);
+            a.rr(false, {0x89}, rax, r13);
+            a.mem(false, {0x83}, 7, rbp, CTX(Error));
+            a.byte(0);
+            errors.push_back(a.jcc(c_ne));
+            reloadTape();
+            moved();
+            break;
+        default: break;
+    }
+}
+
+std::vector<unsigned char> &X64Compiler::compile() {
+    //int entry(Context *c): save the callee-saved registers we pin, keeping rsp 16-byte aligned
+    for (Reg r : {rbp, rbx, r12, r13, r14, r15})
+        a.push(r);
+    a.bytes({0x48, 0x83, 0xEC, 0x08});
+    a.rr(true, {0x89}, arg0, rbp);
+    a.mem(true, {0x89}, rsp, rbp, CTX(Stack));
+    a.mem(true, {0x8B}, rbx, rbp, CTX(Regs));
+    a.mem(false, {0x8B}, r13, rbp, CTX(Ptr));
+    reloadTape();
+    jumps.emplace_back(a.jmp(), prog->Functions[0].Entry);
+
+    native.resize(prog->Code.size());
+    for (pc = 0; pc < prog->Code.size(); pc++) {
+        native[pc] = a.here();
+        instr(prog->Code[pc]);
+    }
+
+    //errors unwind straight back to the entry frame
+    for (size_t at : errors)
+        a.bind(at);
+    a.mem(true, {0x8B}, rsp, rbp, CTX(Stack));
+    a.mem(false, {0x89}, r13, rbp, CTX(Ptr));
+    a.bytes({0x31, 0xC0});
+    for (size_t at : exits)
+        a.bind(at);
+    a.bytes({0x48, 0x83, 0xC4, 0x08});
+    for (Reg r : {r15, r14, r13, r12, rbx, rbp})
+        a.pop(r);
+    a.byte(0xC3);
+
+    for (auto &j : jumps)
+        a.patch(j.first, native[j.second]);
+    return a.buf;
+}
+
+}
+#endif
+
+bool JIT::Supported() {
+#ifdef JIT_X64
+    return true;
+#else
+    return false;
+#endif
+}
+
+JIT::~JIT() {
+#ifdef JIT_X64
+    if (code) {
+#ifdef _WINDOWS
+        VirtualFree(code, 0, MEM_RELEASE);
+#else
+        munmap(code, codeSize);
+#endif
+    }
+#endif
+}
+
+bool JIT::compile(const Bytecode *prog) {
+#ifdef JIT_X64
+    if (code || prog->Functions.empty())
+        return false;
+    //each call starts its frame inside the caller's, so MaxDepth calls need at most MaxDepth of the largest frame
+    //beyond the entry frame. programs needing an unreasonably large file are left to the VM, which grows its own
+    size_t frame = 0;
+    for (auto &f : prog->Functions)
+        frame = std::max<size_t>(frame, f.Frame);
+    size_t size = prog->Functions[0].Frame + frame * CallStack::MaxDepth;
+    if (size > MaxRegs) return false;
+    regs.assign(size, 0);
+    X64Compiler compiler(prog);
+    std::vector<unsigned char> &bin = compiler.compile();
+    //written while writable, then flipped to executable so the buffer is never both
+#ifdef _WINDOWS
+    void *mem = VirtualAlloc(nullptr, bin.size(), MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+    if (!mem) return false;
+    memcpy(mem, bin.data(), bin.size());
+    DWORD old;
+    if (!VirtualProtect(mem, bin.size(), PAGE_EXECUTE_READ, &old)) {
+        VirtualFree(mem, 0, MEM_RELEASE);
+        return false;
+    }
+#else
+    void *mem = mmap(nullptr, bin.size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) return false;
+    memcpy(mem, bin.data(), bin.size());
+    if (mprotect(mem, bin.size(), PROT_READ | PROT_EXEC) != 0) {
+        munmap(mem, bin.size());
+        return false;
+    }
+#endif
+    code = mem;
+    codeSize = bin.size();
+    locs = prog->Locs;
+    reach = prog->Reach;
+    return true;
+#else
+    return false;
+#endif
+}
+
+int JIT::run() {
+#ifdef JIT_X64
+    Context c{};
+    c.Reach = reach;
+    c.Ptr = ptr < 0 ? 0 : ptr;
+    c.Regs = regs.data();
+    c.Store = &tape;
+    c.Io = io;
+    if ((size_t)c.Ptr + reach < tape.getSize())
+        setTape(&c);
+    else if (!growTape(&c, c.Ptr, 1))
+        c.Error = e_memory;
+    int result = c.Error ? 0 : ((int (*)(Context*))code)(&c);
+    ptr = c.Ptr;
+    io->flush();
+    if (c.Error) {
+        std::string msg;
+        switch (c.Error) {
+            case e_cell: msg = "Cell " + std::to_string(c.Value) + " is out of range"; break;
+            case e_ptr: msg = "Pointer moved out of range to " + std::to_string(c.Value); break;
+            case e_div: msg = "Division by zero"; break;
+            case e_depth: msg = CallStack::Overflow; break;
+            case e_idiom:
+                throw std::exception(("RuntimeException: Pointer moved out of range to " + std::to_string(c.Value) +
+                                      " at " + c.ErrorLoc->toString()).c_str());
+            default: msg = "Out of memory"; break;
+        }
+        throw std::exception(("RuntimeException: " + msg + " at " + locs[c.ErrorPc].toString()).c_str());
+    }
+    return result;
+#else
+    throw std::exception("RuntimeException: the JIT is not supported on this machine");
+#endif
+}
@@ -0,0 +1,42 @@
+//
+// Created by 7budd on 10/18/2026.
+//
+#ifndef BRAINPLUS_JIT_H
+#define BRAINPLUS_JIT_H
+
+#include <vector>
+#include "Bytecode.h"
+#include "IO.h"
+#include "Tape.h"
+
+//x86-64 backend: translates Bytecode into native code in an executable mmap'd buffer
+//while running, the tape base, tape limit, tape pointer and current cell pointer are pinned in registers
+//and bytecode registers live in a memory frame addressed from another pinned register.
+//. and , call out to C++ helpers. on other architectures Supported() is false and callers use the VM.
+//generated code indexes the tape directly, so it always uses a dense Tape.
+//calls nest on the native stack, so programs should be run through CallStack::Run.
+class JIT {
+    static const size_t MaxRegs = 1 << 24;
+    Tape tape;
+    std::vector<int> regs;
+    std::vector<Location> locs;
+    int ptr, reach;
+    IO *io;
+    void *code;
+    size_t codeSize;
+public:
+    static bool Supported();
+    explicit JIT(IO *io) : ptr(0), reach(0), io(io), code(nullptr), codeSize(0) {}
+    ~JIT();
+    JIT(const JIT&) = delete;
+    JIT &operator=(const JIT&) = delete;
+
+    //returns false if the program could not be compiled for this machine
+    bool compile(const Bytecode *prog);
+    int run();
+    int getPtr() const { return ptr; }
+    int getCell(int addr) const { return tape.get(addr); }
+    const Tape &getTape() const { return tape; }
+};
+
+#endif //BRAINPLUS_JIT_H
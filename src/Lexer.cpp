@@ -6,46 +6,16 @@
 #include <utility>
 
 //Token
-Token::Token(TokenType t, Location l) { create(t, l); }
-Token::Token(int n, Location l) { create(n, l); }
-Token::Token(Operator op, Location l) { create(op, l); }
-Token::Token(std::string id, bool isIden, Location l) { create(std::move(id), isIden, l); }
-Token::Token(std::string id, Location l) { create(std::move(id), l); }
-Token::Token(Token *tok) { copy(tok); }
+Token::Token(TokenType t, Location l) : Type(t), Number(0), Op(Operator::null), Id(0), Offset(0), Loc(l) {}
+Token::Token(int n, Location l) : Token(TokenType::t_number, l) { Number = n; }
+Token::Token(Operator op, Location l) : Token(TokenType::t_op, l) { Op = op; }
+Token::Token(const std::string& id, bool isIden, Location l) :
+    Token(isIden ? TokenType::t_identifier : TokenType::t_string, l) { Id = Interner::Intern(id); }
+Token::Token(const std::string& id, Location l) : Token(id, true, l) {}
 
-Token *Token::create(TokenType t, Location l) {
-    Type = t;
-    Loc = l;
-    Number = 0;
-    Op = Operator::null;
-    return this;
-}
-Token *Token::create(int n, Location l) {
-    create(TokenType::t_number, l);
-    Number = n;
-    return this;
-}
-Token *Token::create(Operator op, Location l) {
-    create(TokenType::t_op, l);
-    Op = op;
-    return this;
-}
-Token *Token::create(std::string id, bool isIden, Location l) {
-    create(isIden ? TokenType::t_identifier : TokenType::t_string, l);
-    Identifier = std::move(id);
-    return this;
-}
-Token *Token::create(std::string id, Location l) {
-    create(std::move(id), true, l);
-    return this;
-}
-
-void Token::copy(Token *tok) {
-    Loc = tok->Loc;
-    Type = tok->Type;
-    Identifier = Type == TokenType::t_identifier || Type == TokenType::t_string ? tok->Identifier : "";
-    Number = Type == TokenType::t_number ? tok->Number : 0;
-    Op = Type == TokenType::t_op ? tok->Op : Operator::null;
+const std::string &Token::getIdentifier() const {
+    static const std::string none;
+    return Type == TokenType::t_identifier || Type == TokenType::t_string ? Interner::Lookup(Id) : none;
 }
 std::string Token::toString() const {
     switch (Type) {
@@ -58,18 +28,45 @@ std::string Token::toString() const {
         case t_while: return "while";
         case t_do: return "do";
         case t_number: return "N:" + std::to_string(Number);
-        case t_identifier: return "ID:" + Identifier;
-        case t_string: return "S:" + Identifier;
+        case t_identifier: return "ID:" + getIdentifier();
+        case t_string: return "S:" + getIdentifier();
         case t_op: return "OP:" + EnumOps::OpToStr(Op);
         default: return {0, (char)Type};
     }
 }
 
 //Lexer
+//keywords are looked up by interned id instead of by string comparison
+static const struct { Symbol Id; TokenType Type; } keywords[] = {
+    {Interner::Intern("include"), TokenType::t_include},
+    {Interner::Intern("define"),  TokenType::t_define},
+    {Interner::Intern("enddef"),  TokenType::t_enddef},
+    {Interner::Intern("if"),      TokenType::t_if},
+    {Interner::Intern("else"),    TokenType::t_else},
+    {Interner::Intern("for"),     TokenType::t_for},
+    {Interner::Intern("while"),   TokenType::t_while},
+    {Interner::Intern("do"),      TokenType::t_do}
+};
+
+Lexer::Lexer(const std::string& filename, bool mapSource) : lexLoc({1,0}), curTok(nullptr), curLoc({1,0}),
+    fname(filename), pos(0), expansions(0), curChar(' ') {
+    //lex the whole file up front into one contiguous array, the source is not needed afterwards
+    SourceBuffer source(filename, mapSource);
+    opened = source.good();
+    begin = cur = source.begin();
+    end = source.end();
+    sourceSize = source.length();
+    tokens.reserve(source.length() / 4 + 1);
+    do {
+        tokens.push_back(lexToken());
+        tokens.back().Offset = tokOffset;
+    } while (tokens.back().Type != TokenType::t_eof);
+    begin = cur = end = nullptr;
+    getNextToken();
+}
 int Lexer::advance() {
-    curChar = file->get();
-    while (curChar == '\r')
-        curChar = file->get();
+    do curChar = cur < end ? (unsigned char)*cur++ : EOF;
+    while (curChar == '\r');
     if (curChar == '\n') {
         lexLoc.Line++;
         lexLoc.Col = 0;
@@ -127,7 +124,10 @@ Operator Lexer::parseOp() {
         case '@': { //ptr operators
             if (advance() == '@')
                 return Operator::ptr_lookup;
-            std::streampos pos = file->tellg();
+            //remember where the op after '@' starts so it can be un-read if it isn't a ptr op
+            const char *mark = cur;
+            int markChar = curChar;
+            Location markLoc = lexLoc;
             switch(parseOp()) {
                 case Operator::addition:       return Operator::ptr_addition;
                 case Operator::subtraction:    return Operator::ptr_subtraction;
@@ -150,7 +150,9 @@ Operator Lexer::parseOp() {
                         break;
                     } else return Operator::ptr_lookupRelUp;
                 default:
-                    file->seekg(pos); //reset position in case non-ptr op parsed
+                    cur = mark; //reset position in case non-ptr op parsed
+                    curChar = markChar;
+                    lexLoc = markLoc;
                     return Operator::ptr_lookup;
             }
             break;
@@ -160,16 +162,26 @@ Operator Lexer::parseOp() {
     advance();
     return op;
 }
-Token *Lexer::getNextToken() {
-    if (!defRep->empty()) {
-        curTok->copy(defRep->back());
-        defRep->pop_back();
-        curTok->Loc = lexLoc;
-        return curTok;
+const Token *Lexer::getNextToken() {
+    if (!pending.empty()) {
+        Expansion &e = pending.back();
+        curTok = e.Cur++;
+        curLoc = e.Loc;
+        //popped as soon as it is used up, so a define ending in another define doesn't grow the stack
+        if (e.Cur == e.End) pending.pop_back();
+    } else {
+        curTok = &tokens[pos];
+        curLoc = curTok->Loc;
+        if (pos + 1 < tokens.size()) //stay on the trailing eof
+            pos++;
     }
+    return curTok;
+}
+Token Lexer::lexToken() {
     while (isspace(curChar))
         advance();
     Location curLoc = lexLoc;
+    tokOffset = curChar == EOF ? end - begin : cur - begin - 1;
     TokenType tt;
     Operator op;
 
@@ -178,15 +190,11 @@ Token *Lexer::getNextToken() {
         while(isalnum(advance()) || curChar == '_')
             str += (char)curChar;
 
-        if (str == "include") tt = TokenType::t_include;
-        else if (str == "define") tt = TokenType::t_define;
-        else if (str == "enddef") tt = TokenType::t_enddef;
-        else if (str == "if") tt = TokenType::t_if;
-        else if (str == "else") tt = TokenType::t_else;
-        else if (str == "for") tt = TokenType::t_for;
-        else if (str == "while") tt = TokenType::t_while;
-        else if (str == "do") tt = TokenType::t_do;
-        else return curTok->create(str, curLoc);
+        Token tok(str, curLoc);
+        for (const auto& kw : keywords)
+            if (kw.Id == tok.Id)
+                return {kw.Type, curLoc}; //curChar is already past the keyword
+        return tok;
     } else if (isdigit(curChar)) {
         int n = 0;
         do {
@@ -205,7 +213,7 @@ Token *Lexer::getNextToken() {
                 n = (n << 4) + t;
             }
         }
-        return curTok->create(n, curLoc);
+        return {n, curLoc};
     } else if (curChar == '\'') {
         if (advance() == '\'') {
             advance();
@@ -229,7 +237,7 @@ Token *Lexer::getNextToken() {
                 case '6': curChar = '\6'; break;
                 case '7': curChar = '\7'; break;
             }
-        curTok->create(curChar, curLoc);
+        Token tok(curChar, curLoc);
         if (advance() != '\'') {
             while (advance() != '\'' && curChar != EOF);
             if (curChar == EOF)
@@ -240,12 +248,12 @@ Token *Lexer::getNextToken() {
                                   "character constant at " + curLoc.toString()).c_str());
         }
         advance();
-        return curTok;
+        return tok;
     } else if (curChar == '/') {
         advance();
         if (curChar == '/') {
             while (advance() != '\n' && curChar != EOF);
-            return getNextToken();
+            return lexToken();
         } else if (curChar == '*') {
             advance();
             do {
@@ -256,8 +264,8 @@ Token *Lexer::getNextToken() {
                 advance();
             } while (curChar != '/');
             advance(); //eat '/'
-            return getNextToken();
-        } else return curTok->create(Operator::division, curLoc);
+            return lexToken();
+        } else return {Operator::division, curLoc};
     } else if (curChar == '\"') {
         std::string str;
         while (advance() != '\"' && curChar != EOF)
@@ -265,12 +273,12 @@ Token *Lexer::getNextToken() {
         if (curChar == EOF)
             throw std::exception(("SyntaxException: String literal never closed at "+curLoc.toString()).c_str());
         advance(); //eat ending quote
-        return curTok->create(str, false, curLoc);
+        return {str, false, curLoc};
     } else if (curChar == EOF) tt = TokenType::t_eof;
     else if ((op = parseOp()) != Operator::null) {
-        return curTok->create(op, curLoc);
+        return {op, curLoc};
     } else tt = (TokenType)curChar;
 
     advance();
-    return curTok->create(tt, curLoc);
+    return {tt, curLoc};
 }
@@ -6,9 +6,10 @@
 
 #include <string>
 #include <utility>
-#include <fstream>
 #include <vector>
 #include "enums.h"
+#include "SourceBuffer.h"
+#include "Interner.h"
 
 struct Location {
     int Line, Col;
@@ -17,80 +18,90 @@ struct Location {
     }
 };
 
+//plain-data token. Identifiers and strings are stored as interned ids (see Interner)
 class Token {
 public:
     TokenType Type;
     int Number;
     Operator Op;
-    std::string Identifier;
+    Symbol Id;              //interned identifier or string, only set for t_identifier and t_string
+    unsigned int Offset;    //byte offset of the token in its source file
     Location Loc;
-    Token(){}   //*only temporary for Lexer constructor. DO NOT USE
+    Token() = default;
     Token(TokenType t, Location l);
     Token(int n, Location l);
     Token(Operator op, Location l);
-    Token(std::string id, bool isIden, Location l);
-    Token(std::string id, Location l);
-    Token(Token *tok);
+    Token(const std::string& id, bool isIden, Location l);
+    Token(const std::string& id, Location l);
 
-    Token *create(TokenType t, Location l);
-    Token *create(int n, Location l);
-    Token *create(Operator op, Location l);
-    Token *create(std::string id, bool isIden, Location l);
-    Token *create(std::string id, Location l);
-
-    void copy(Token *tok);
+    const std::string &getIdentifier() const;
     std::string toString() const;
 };
 
+//define replacements are expanded lazily: each one in progress is a cursor over the define's own tokens, so tokens
+//are handed out by pointer and never copied. the current token keeps the location it was written at;
+//getCurrentLocation() gives the location it is used at, which for a replacement is that of the define reference.
 class Lexer {
 private:
+    //the rest of a replacement being expanded
+    struct Expansion {
+        const Token *Cur, *End;
+        Location Loc;
+    };
     Location lexLoc;
-    Token *curTok;
+    const Token *curTok;
+    Location curLoc;            //where curTok is used
+    Token rolledBack;
     std::string fname;
-    std::vector<Token*> *defRep;
-    std::ifstream *file;
+    std::vector<Token> tokens;  //the whole file, lexed up front. always ends with t_eof
+    unsigned int pos;           //index of the next token in tokens
+    std::vector<Expansion> pending;     //innermost last. finished ones are popped right away
+    const char *begin, *cur, *end;
+    unsigned int tokOffset;
+    size_t sourceSize;
+    unsigned int expansions;    //defines replaced while parsing
+    bool opened;
     int curChar;
     int advance();
     Operator parseOp();
+    Token lexToken();
 public:
-    explicit Lexer(const std::string& filename) : lexLoc({1,0}), curChar(' '), curTok(new Token()) {
-        defRep = new std::vector<Token*>();
-        fname = filename;
-        file = new std::ifstream(filename);
-        getNextToken();
-    }
-    ~Lexer() {
-        while (!defRep->empty()) {
-            delete defRep->back();
-            defRep->pop_back();
-        }
-        delete defRep;
-        delete curTok;
-        file->close();
-        delete file;
-    }
+    //mapSource = false reads the whole file into a buffer instead of memory-mapping it
+    explicit Lexer(const std::string& filename, bool mapSource = true);
 
-    Token *getCurrentToken() {return curTok;}
+    const Token *getCurrentToken() const {return curTok;}
     TokenType getCurrentType() const {return curTok->Type;}
-    std::string getCurrentIdentifier() const {return curTok->Identifier;}
+    const std::string &getCurrentIdentifier() const {return curTok->getIdentifier();}
+    Symbol getCurrentSymbol() const {return curTok->Id;}
     Operator getCurrentOp() const {return curTok->Op;}
-    Location getCurrentLocation() const {return curTok->Loc;}
-    std::string getCurrentLocString() const {return curTok->Loc.toString();}
+    Location getCurrentLocation() const {return curLoc;}
+    std::string getCurrentLocString() const {return curLoc.toString();}
 
-    Token *getNextToken();
+    const Token *getNextToken();
     TokenType getNextType() {return getNextToken()->Type;}
+    unsigned int getNumTokens() const {return tokens.size();}
+    size_t getSourceSize() const {return sourceSize;}
+    unsigned int getNumExpansions() const {return expansions;}
 
-    bool good() {return file->good();}
+    bool good() {return opened;}
     std::string getFileName() {return fname;}
-    void setReplacement(std::vector<Token*> *rep) {
-        for (unsigned int i = rep->size();i > 1;)
-            defRep->push_back(rep->at(--i));
-        curTok->copy(rep->front());
-        curTok->Loc = lexLoc;
+    //replaces the current token (a define reference) with `rep`, which must outlive the expansion
+    void setReplacement(const std::vector<Token>& rep) {
+        expansions++;
+        if (rep.empty()) {
+            getNextToken();
+            return;
+        }
+        if (rep.size() > 1)
+            pending.push_back({rep.data() + 1, rep.data() + rep.size(), curLoc});
+        curTok = rep.data();
     }
-    void rollback(Token *tok) {
-        defRep->push_back(curTok);
-        curTok = tok;
+    //makes `tok` current again, followed by the current token. only once before the next call to getNextToken
+    void rollback(const Token& tok) {
+        pending.push_back({curTok, curTok + 1, curLoc});
+        rolledBack = tok;
+        curTok = &rolledBack;
+        curLoc = tok.Loc;
     }
 };
 
@@ -0,0 +1,68 @@
+//
+// Created by 7budd on 10/18/2026.
+//
+#include "LoopIdiom.h"
+
+#include <algorithm>
+#include <new>
+
+const Location *LoopIdiom::run(Tape &tape, int &ptr) const {
+    auto at = [&tape](long long addr) -> int& {
+        int *c = tape.cell((size_t)addr);
+        if (!c) throw std::bad_alloc();
+        return *c;
+    };
+    switch (Type) {
+        case Clear: {
+            int &c = at(ptr);
+            if (test(c)) c = 0;
+            return nullptr;
+        }
+        case MulAdd: {
+            int n = at(ptr);
+            if (!test(n)) return nullptr;
+            for (auto &low : Lows)
+                if ((long long)ptr + low.first < 0) {
+                    ptr += low.first;
+                    return &low.second;
+                }
+            //with wraparound the loop runs n (or -n) times even when the condition is != 0 and n has the other sign
+            unsigned int times = Step < 0 ? (unsigned int)n : 0u - (unsigned int)n;
+            for (auto &add : Adds) {
+                int &c = at((long long)ptr + add.first);
+                c = (int)((unsigned int)c + (unsigned int)add.second * times);
+            }
+            at(ptr) = 0;
+            return nullptr;
+        }
+        case Scan: {
+            //cells past the end of the tape or never touched are 0, which fails every condition
+            long long p = ptr, size = (long long)tape.getSize();
+            if (Step == 1 && Cond == notEqual && p < size && tape.data())
+                p = std::find(tape.data() + p, tape.data() + size, 0) - tape.data();
+            else while (p >= 0 && p < size && test(tape.get((int)p)))
+                p += Step;
+            if (p < 0) {
+                ptr = (int)p;
+                return &Lows[0].second;
+            }
+            ptr = (int)std::min<long long>(p, 0x7fffffff);
+            at(ptr);
+            return nullptr;
+        }
+    }
+    return nullptr;
+}
+
+std::string LoopIdiom::to_string() const {
+    std::string str = "[" + std::string(Type == Clear ? "clear" : Type == MulAdd ? "muladd" : "scan") +
+                      " while " + EnumOps::OpToStr(Cond) + "0";
+    if (Type == MulAdd) {
+        str += Step < 0 ? ", -1:" : ", +1:";
+        for (auto &add : Adds)
+            str += (add.first < 0 ? " @##" + std::to_string(-add.first) : " @#" + std::to_string(add.first)) +
+                   "+=" + std::to_string(add.second);
+    } else if (Type == Scan)
+        str += Step < 0 ? " @-" + std::to_string(-Step) : " @+" + std::to_string(Step);
+    return str + ']';
+}
@@ -0,0 +1,33 @@
+//
+// Created by 7budd on 10/18/2026.
+//
+#ifndef BRAINPLUS_LOOPIDIOM_H
+#define BRAINPLUS_LOOPIDIOM_H
+
+#include <string>
+#include <utility>
+#include <vector>
+#include "Lexer.h"
+#include "Tape.h"
+
+//Closed form of a loop the Optimizer recognized. every engine runs it with the same routine
+//  Clear:  while (cell Cond 0) { -1 or +1 }                      cell = 0
+//  MulAdd: while (cell Cond 0) { +-k at fixed offsets around the cell, pointer back where it started, loop cell +-1 }
+//          every offset cell += k * iterations, then cell = 0
+//  Scan:   while (cell Cond 0) { @+k or @-k }                    moves to the first cell that fails the condition
+struct LoopIdiom {
+    enum Kind { Clear, MulAdd, Scan } Type;
+    Operator Cond;                                  //notEqual, greaterThan or lessThan
+    int Step;                                       //loop cell change per iteration, or pointer move for Scan
+    std::vector<std::pair<int, int>> Adds;          //MulAdd: (offset, amount added per iteration)
+    std::vector<std::pair<int, Location>> Lows;     //each new lowest offset the body moves to, and the move's location
+
+    bool test(int cell) const { return Cond == notEqual ? cell != 0 : Cond == greaterThan ? cell > 0 : cell < 0; }
+    //runs the loop on the tape, growing it as needed. if the original loop would have moved the pointer below 0,
+    //ptr is left where it moved to and the location of that move is returned, otherwise null.
+    //throws std::bad_alloc if the tape can't grow
+    const Location *run(Tape &tape, int &ptr) const;
+    std::string to_string() const;
+};
+
+#endif //BRAINPLUS_LOOPIDIOM_H
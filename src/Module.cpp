@@ -0,0 +1,53 @@
+//
+// Created by 7budd on 10/18/2026.
+//
+#include "Module.h"
+#include "ASTCodec.h"
+
+#include <cstddef>
+#include <cstring>
+
+namespace {
+    const char Magic[4] = { 'B', 'P', 'M', 0 };
+}
+
+std::string Module::Save(const SymbolTable<DefineNode> &defines, const SymbolTable<FunctionNode> &functions) {
+    //the body goes first so the string table is complete before it is written
+    ASTWriter body(true), w;
+    body.defines(std::vector<DefineNode*>(defines.begin(), defines.end()));
+    body.functions(std::vector<FunctionNode*>(functions.begin(), functions.end()));
+    w.Out.append(Magic, sizeof(Magic));
+    w.u32(Version);
+    w.u32(body.Strings.size());
+    for (auto &s : body.Strings)
+        w.str(s);
+    return w.Out + body.Out;
+}
+
+bool Module::Load(const char *begin, const char *end, ASTArena *arena, std::vector<DefineNode*> &defines,
+                  std::vector<FunctionNode*> &functions, std::string &error) {
+    if (end - begin < (ptrdiff_t)sizeof(Magic) || memcmp(begin, Magic, sizeof(Magic)) != 0) {
+        error = "is not a module";
+        return false;
+    }
+    ASTReader r(begin + sizeof(Magic), end);
+    unsigned int version = r.u32();
+    if (r.Ok && version != Version) {
+        error = "was written for module format " + std::to_string(version) + ", expected " + std::to_string(Version);
+        return false;
+    }
+    std::vector<Symbol> symbols;
+    uint32_t n = r.u32();
+    for (uint32_t i = 0; i < n && r.Ok; i++)
+        symbols.push_back(Interner::Intern(r.str()));
+    r.useTable(&symbols);
+    std::vector<DefineNode*> defs;
+    std::vector<FunctionNode*> funcs;
+    if (!r.defines(arena, defs) || !r.functions(arena, funcs) || !r.done()) {
+        error = "is truncated or corrupt";
+        return false;
+    }
+    defines.insert(defines.end(), defs.begin(), defs.end());
+    functions.insert(functions.end(), funcs.begin(), funcs.end());
+    return true;
+}
@@ -0,0 +1,30 @@
+//
+// Created by 7budd on 10/18/2026.
+//
+#ifndef BRAINPLUS_MODULE_H
+#define BRAINPLUS_MODULE_H
+
+#include <string>
+#include <vector>
+#include "ASTNodes.h"
+#include "SymbolTable.h"
+
+//Precompiled module (.bpm): the defines and functions of a library, parsed ahead of time (--emit-module)
+//so that `include "lib.bpm"` loads them without lexing or parsing.
+//defines are stored already expanded and function bodies unoptimized, so a module doesn't include anything itself.
+//every name is stored once in a string table and interned once on load. callers memory-map the file (SourceBuffer)
+//and the nodes are decoded straight from the mapping into the arena; the AST links nodes by pointer, so they can't
+//be used in place.
+class Module {
+public:
+    //bump when the layout changes; modules of other versions are rejected
+    static const unsigned int Version = 1;
+
+    static std::string Save(const SymbolTable<DefineNode> &defines, const SymbolTable<FunctionNode> &functions);
+    //decodes the module in [begin, end). nodes are allocated in `arena`
+    //returns false with the reason in `error` if it isn't a module, was written by another version or is corrupt
+    static bool Load(const char *begin, const char *end, ASTArena *arena, std::vector<DefineNode*> &defines,
+                     std::vector<FunctionNode*> &functions, std::string &error);
+};
+
+#endif //BRAINPLUS_MODULE_H
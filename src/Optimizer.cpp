@@ -0,0 +1,665 @@
+//
+// Created by 7budd on 10/18/2026.
+//
+#include "Optimizer.h"
+
+#include <algorithm>
+#include <climits>
+
+//two's complement wraparound, matching what the engines do on overflow
+static int wrap(long long v) { return (int)(unsigned int)(unsigned long long)v; }
+static bool IsValueOp(Operator op) {
+    return op == addition || op == subtraction || op == multiplication || op == division || op == assignment ||
+           op == bit_not || op == bit_and || op == bit_or || op == bit_xor;
+}
+//applies a value op with a constant operand to a known cell. false if it would raise an error
+static bool Apply(Operator op, int cell, int k, int &result) {
+    switch (op) {
+        case addition:       result = wrap((long long)cell + k); return true;
+        case subtraction:    result = wrap((long long)cell - k); return true;
+        case multiplication: result = wrap((long long)cell * k); return true;
+        case division:
+            if (k == 0) return false;
+            result = k == -1 ? wrap(-(long long)cell) : cell / k;
+            return true;
+        case assignment:     result = k; return true;
+        case bit_not:        result = ~k; return true;
+        case bit_and:        result = cell & k; return true;
+        case bit_or:         result = cell | k; return true;
+        case bit_xor:        result = cell ^ k; return true;
+        default: return false;
+    }
+}
+
+bool Optimizer::IsConst(StatementNode *s, int &k) {
+    if (!s) {
+        k = 0;      //engines treat a missing operand as 0
+        return true;
+    }
+    if (s->getType() != NodeType::Number) return false;
+    k = ((NumberNode*)s)->getNumber();
+    return true;
+}
+
+//replaces every child statement of s with f(child). f is also called for absent optional children (null)
+template <typename F>
+static void MapChildren(StatementNode *s, F f) {
+    switch (s->getType()) {
+        case NodeType::MultiStatement:
+            for (auto &st : ((MultiStatementNode*)s)->getStatements())
+                st = f(st);
+            break;
+        case NodeType::BinaryOperator:
+            ((BinaryOperatorNode*)s)->setLHS(f(((BinaryOperatorNode*)s)->getLHS()));
+            //fall through
+        case NodeType::UnaryOperator:
+            ((UnaryOperatorNode*)s)->setRHS(f(((UnaryOperatorNode*)s)->getRHS()));
+            break;
+        case NodeType::If:
+        case NodeType::Ternary:
+            ((IfTernaryNode*)s)->setElse(f(((IfTernaryNode*)s)->getElse()));
+            //fall through
+        case NodeType::Do:
+        case NodeType::While:
+            ((DoWhileNode*)s)->setExpression(f(((DoWhileNode*)s)->getExpression()));
+            ((DoWhileNode*)s)->setBody(f(((DoWhileNode*)s)->getBody()));
+            break;
+        case NodeType::For:
+            ((ForNode*)s)->setStart(f(((ForNode*)s)->getStart()));
+            ((ForNode*)s)->setExpression(f(((ForNode*)s)->getExpression()));
+            ((ForNode*)s)->setStep(f(((ForNode*)s)->getStep()));
+            ((ForNode*)s)->setBody(f(((ForNode*)s)->getBody()));
+            break;
+        default: break;
+    }
+}
+
+//MapChildren, also telling f whether the value of each child is used when the value of s is (want).
+//the values of loop and if bodies, for loop starts and steps, and all but the last statement of a list never are
+template <typename F>
+static void MapUses(StatementNode *s, bool want, F f) {
+    switch (s->getType()) {
+        case NodeType::MultiStatement: {
+            auto &st = ((MultiStatementNode*)s)->getStatements();
+            for (size_t i = 0; i < st.size(); i++)
+                st[i] = f(st[i], want && i + 1 == st.size());
+            break;
+        }
+        case NodeType::If:
+            ((IfTernaryNode*)s)->setElse(f(((IfTernaryNode*)s)->getElse(), false));
+            //fall through
+        case NodeType::Do:
+        case NodeType::While:
+            ((DoWhileNode*)s)->setExpression(f(((DoWhileNode*)s)->getExpression(), true));
+            ((DoWhileNode*)s)->setBody(f(((DoWhileNode*)s)->getBody(), false));
+            break;
+        case NodeType::For:
+            ((ForNode*)s)->setStart(f(((ForNode*)s)->getStart(), false));
+            ((ForNode*)s)->setExpression(f(((ForNode*)s)->getExpression(), true));
+            ((ForNode*)s)->setStep(f(((ForNode*)s)->getStep(), false));
+            ((ForNode*)s)->setBody(f(((ForNode*)s)->getBody(), false));
+            break;
+        default:
+            MapChildren(s, [&f](StatementNode *c) { return f(c, true); });
+            break;
+    }
+}
+
+template <typename F>
+static void ForEachCall(StatementNode *s, F f) {
+    if (!s) return;
+    if (s->getType() == NodeType::Call) f((CallNode*)s);
+    MapChildren(s, [&f](StatementNode *c) { ForEachCall(c, f); return c; });
+}
+
+StatementNode *Optimizer::run(StatementNode *code) {
+    //calls are inlined first so the passes below can see through them
+    for (auto func : *funcs)
+        expand(func);
+    code = code ? optimize(inlineCalls(code)) : nullptr;
+    //functions are optimized as they are reached from the optimized code, so calls in dead code don't count
+    std::vector<FunctionNode*> reached;
+    std::vector<bool> seen(Interner::Size(), false);
+    auto reach = [&](CallNode *c) {
+        FunctionNode *f = funcs->find(c->getSymbol());
+        if (!f || seen[f->getSymbol()]) return;
+        seen[f->getSymbol()] = true;
+        reached.push_back(f);
+    };
+    ForEachCall(code, reach);
+    for (size_t i = 0; i < reached.size(); i++)
+        if (reached[i]->getBody()) {
+            reached[i]->setBody(optimize(reached[i]->getBody()));
+            ForEachCall(reached[i]->getBody(), reach);
+        }
+    std::vector<Symbol> unreached;
+    for (auto func : *funcs)
+        if (!seen[func->getSymbol()])
+            unreached.push_back(func->getSymbol());
+    for (Symbol id : unreached)
+        funcs->erase(id);
+    return code;
+}
+StatementNode *Optimizer::optimize(StatementNode *s) {
+    s = fold(s);
+    s = dce(s, true);
+    s = idioms(s);
+    s = offsets(s, true);
+    return deadStores(s, true);
+}
+
+//inlining
+//functions have no parameters, so a call can be replaced by a copy of the body: its value is the body's value
+//and it runs on the same tape and pointer. bodies of at most MaxInlineSize nodes (after their own calls are
+//inlined) are copied; recursive calls are left alone.
+static const unsigned int MaxInlineSize = 64;
+
+static unsigned int Size(StatementNode *s) {
+    if (!s) return 0;
+    unsigned int n = 1;
+    MapChildren(s, [&n](StatementNode *c) { n += Size(c); return c; });
+    return n;
+}
+
+//deep copy, so the passes can rewrite every inlined body in place
+StatementNode *Optimizer::clone(StatementNode *s) {
+    if (!s) return nullptr;
+    Location l = s->getLoc();
+    NullaryOperatorNode *copy;
+    switch (s->getType()) {
+        case NodeType::MultiStatement: {
+            std::vector<StatementNode*> statements;
+            for (auto st : ((MultiStatementNode*)s)->getStatements())
+                statements.push_back(clone(st));
+            return arena->make<MultiStatementNode>(std::move(statements), l);
+        }
+        case NodeType::Number: return number(((NumberNode*)s)->getNumber(), l);
+        case NodeType::Call: return arena->make<CallNode>(((CallNode*)s)->getSymbol(), l);
+        case NodeType::NullaryOperator:
+            copy = arena->make<NullaryOperatorNode>(((NullaryOperatorNode*)s)->getOp(), l);
+            break;
+        case NodeType::UnaryOperator:
+            copy = arena->make<UnaryOperatorNode>(((UnaryOperatorNode*)s)->getOp(), clone(((UnaryOperatorNode*)s)->getRHS()), l);
+            break;
+        case NodeType::BinaryOperator:
+            copy = arena->make<BinaryOperatorNode>(((BinaryOperatorNode*)s)->getOp(), clone(((BinaryOperatorNode*)s)->getLHS()),
+                                                   clone(((BinaryOperatorNode*)s)->getRHS()), l);
+            break;
+        case NodeType::Do:
+        case NodeType::While:
+            return arena->make<DoWhileNode>(clone(((DoWhileNode*)s)->getExpression()), clone(((DoWhileNode*)s)->getBody()),
+                                            s->getType() == NodeType::While, l);
+        case NodeType::If:
+        case NodeType::Ternary:
+            return arena->make<IfTernaryNode>(clone(((IfTernaryNode*)s)->getExpression()), clone(((IfTernaryNode*)s)->getBody()),
+                                              clone(((IfTernaryNode*)s)->getElse()), s->getType() == NodeType::Ternary, l);
+        case NodeType::For:
+            return arena->make<ForNode>(clone(((ForNode*)s)->getStart()), clone(((ForNode*)s)->getExpression()),
+                                        clone(((ForNode*)s)->getStep()), clone(((ForNode*)s)->getBody()), l);
+        case NodeType::Idiom: return arena->make<IdiomNode>(((IdiomNode*)s)->getIdiom(), l);
+        default: return s;
+    }
+    copy->setOffset(((NullaryOperatorNode*)s)->getOffset());
+    return copy;
+}
+void Optimizer::expand(FunctionNode *f) {
+    if (f->getSymbol() >= expanded.size())
+        expanded.resize(f->getSymbol() + 1, 0);
+    if (expanded[f->getSymbol()]) return;
+    expanded[f->getSymbol()] = 1;
+    f->setBody(inlineCalls(f->getBody()));
+    expanded[f->getSymbol()] = 2;
+}
+StatementNode *Optimizer::inlineCalls(StatementNode *s) {
+    if (!s) return nullptr;
+    if (s->getType() == NodeType::Call) {
+        FunctionNode *f = funcs->find(((CallNode*)s)->getSymbol());
+        if (!f) return s;       //reported by the engines
+        expand(f);
+        unsigned int size = Size(f->getBody());
+        if (expanded[f->getSymbol()] != 2 || size > MaxInlineSize)
+            return s;
+        inlined.push_back({f->getSymbol(), s->getLoc(), size});
+        return f->getBody() ? clone(f->getBody()) : number(0, s->getLoc());
+    }
+    MapChildren(s, [this](StatementNode *c) { return inlineCalls(c); });
+    if (s->getType() == NodeType::MultiStatement) {
+        //splice inlined statement lists into this one
+        std::vector<StatementNode*> out;
+        for (auto st : ((MultiStatementNode*)s)->getStatements())
+            if (st->getType() == NodeType::MultiStatement && ((MultiStatementNode*)st)->getNumStatements())
+                out.insert(out.end(), ((MultiStatementNode*)st)->getStatements().begin(),
+                           ((MultiStatementNode*)st)->getStatements().end());
+            else out.push_back(st);
+        ((MultiStatementNode*)s)->getStatements() = std::move(out);
+    }
+    return s;
+}
+
+StatementNode *Optimizer::fold(StatementNode *s) {
+    if (!s) return nullptr;
+    MapChildren(s, [this](StatementNode *c) { return fold(c); });
+    int k;
+    switch (s->getType()) {
+        case NodeType::MultiStatement: coalesce((MultiStatementNode*)s); return s;
+        case NodeType::UnaryOperator: return foldUnary((UnaryOperatorNode*)s);
+        case NodeType::BinaryOperator: return foldBinary((BinaryOperatorNode*)s);
+        case NodeType::Ternary:
+            if (IsConst(((IfTernaryNode*)s)->getExpression(), k))
+                return k ? ((IfTernaryNode*)s)->getBody() : ((IfTernaryNode*)s)->getElse();
+            return s;
+        default: return s;
+    }
+}
+StatementNode *Optimizer::foldUnary(UnaryOperatorNode *s) {
+    int k;
+    if (s->getOp() == Operator::bool_not && IsConst(s->getRHS(), k))
+        return number(!k, s->getLoc());
+    return s;
+}
+StatementNode *Optimizer::foldBinary(BinaryOperatorNode *s) {
+    int l, r;
+    bool lc = IsConst(s->getLHS(), l), rc = IsConst(s->getRHS(), r);
+    Location loc = s->getLoc();
+    switch (s->getOp()) {
+        //a constant left side decides or drops out of a short-circuit op: 1 && x and 0 || x become x != 0
+        case bool_and:
+            if (lc && !l) return number(0, loc);
+            if (lc) return rc ? number(r != 0, loc) : arena->make<BinaryOperatorNode>(notEqual, s->getRHS(), number(0, loc), loc);
+            break;
+        case bool_or:
+            if (lc && l) return number(1, loc);
+            if (lc) return rc ? number(r != 0, loc) : arena->make<BinaryOperatorNode>(notEqual, s->getRHS(), number(0, loc), loc);
+            break;
+        default:
+            if (!lc || !rc) break;
+            switch (s->getOp()) {
+                case bool_xor:       return number(!l != !r, loc);
+                case lessThan:       return number(l < r, loc);
+                case greaterThan:    return number(l > r, loc);
+                case lessOrEqual:    return number(l <= r, loc);
+                case greaterOrEqual: return number(l >= r, loc);
+                case equalTo:        return number(l == r, loc);
+                case notEqual:       return number(l != r, loc);
+                default: break;
+            }
+    }
+    return s;
+}
+
+//merges two consecutive statements on the same cell/pointer into one, or returns null if they can't be
+StatementNode *Optimizer::merge(StatementNode *a, StatementNode *b) {
+    if (a->getType() != NodeType::UnaryOperator || b->getType() != NodeType::UnaryOperator)
+        return nullptr;
+    Operator aOp = ((UnaryOperatorNode*)a)->getOp(), bOp = ((UnaryOperatorNode*)b)->getOp();
+    int ka, kb, k;
+    if (!IsConst(((UnaryOperatorNode*)a)->getRHS(), ka) || !IsConst(((UnaryOperatorNode*)b)->getRHS(), kb))
+        return nullptr;
+    Location l = a->getLoc();
+    if (IsValueOp(aOp) && IsValueOp(bOp)) {
+        if (aOp == division && ka == 0)
+            return nullptr;     //a raises an error, keep it
+        //b overwrites the cell without reading it
+        if (bOp == assignment || bOp == bit_not)
+            return b;
+        //a leaves a known value in the cell
+        if ((aOp == assignment || aOp == bit_not) && Apply(bOp, aOp == assignment ? ka : ~ka, kb, k))
+            return op(assignment, k, l);
+        if ((aOp == addition || aOp == subtraction) && (bOp == addition || bOp == subtraction)) {
+            k = wrap((aOp == addition ? (long long)ka : -(long long)ka) + (bOp == addition ? kb : -(long long)kb));
+            return k < 0 && k != INT_MIN ? op(subtraction, -k, l) : op(addition, k, l);
+        }
+        if (aOp == bOp && (aOp == multiplication || aOp == bit_and || aOp == bit_or || aOp == bit_xor)) {
+            Apply(aOp, ka, kb, k);
+            return op(aOp, k, l);
+        }
+        return nullptr;
+    }
+    //pointer moves. never merge across a move that could leave the tape, since that raises an error
+    if (bOp == ptr_assignment && kb >= 0 && (aOp == ptr_assignment || aOp == ptr_addition) && ka >= 0)
+        return b;
+    if (aOp == ptr_assignment && ka >= 0 && (bOp == ptr_addition || bOp == ptr_subtraction)) {
+        long long p = bOp == ptr_addition ? (long long)ka + kb : (long long)ka - kb;
+        return p >= 0 && p <= INT_MAX ? op(ptr_assignment, (int)p, l) : nullptr;
+    }
+    if (aOp == ptr_addition && bOp == ptr_addition && ka >= 0 && kb >= 0 && (long long)ka + kb <= INT_MAX)
+        return op(ptr_addition, ka + kb, l);
+    return nullptr;
+}
+void Optimizer::coalesce(MultiStatementNode *m) {
+    std::vector<StatementNode*> out;
+    for (StatementNode *s : m->getStatements()) {
+        StatementNode *merged;
+        while (!out.empty() && (merged = merge(out.back(), s))) {
+            out.pop_back();
+            s = merged;
+        }
+        out.push_back(s);
+    }
+    m->getStatements() = std::move(out);
+}
+
+//dead code
+//true if evaluating s has no effect and can't raise an error
+static bool Pure(StatementNode *s) {
+    if (!s) return true;
+    switch (s->getType()) {
+        case NodeType::Number: return true;
+        case NodeType::UnaryOperator: {
+            Operator op = ((UnaryOperatorNode*)s)->getOp();
+            StatementNode *rhs = ((UnaryOperatorNode*)s)->getRHS();
+            if (EnumOps::OpIsValComp(op) || EnumOps::OpIsPtrComp(op) || op == bool_not)
+                return Pure(rhs);
+            //ptr + offset is never negative, so only the lookup's own operand can take it out of range
+            int k = 0;
+            if (rhs && rhs->getType() == NodeType::Number) k = ((NumberNode*)rhs)->getNumber();
+            else if (rhs) return false;
+            return ((op == ptr_lookup || op == ptr_lookupRelUp) && k >= 0) || (op == ptr_lookupRelDown && k <= 0);
+        }
+        case NodeType::BinaryOperator:
+            return Pure(((BinaryOperatorNode*)s)->getLHS()) && Pure(((BinaryOperatorNode*)s)->getRHS());
+        case NodeType::Ternary:
+            return Pure(((IfTernaryNode*)s)->getExpression()) && Pure(((IfTernaryNode*)s)->getBody()) &&
+                   Pure(((IfTernaryNode*)s)->getElse());
+        case NodeType::MultiStatement:
+            for (auto st : ((MultiStatementNode*)s)->getStatements())
+                if (!Pure(st)) return false;
+            return true;
+        default: return false;
+    }
+}
+
+StatementNode *Optimizer::dce(StatementNode *s, bool want) {
+    if (!s) return nullptr;
+    MapUses(s, want, [this](StatementNode *c, bool w) { return dce(c, w); });
+    auto *d = (DoWhileNode*)s;
+    int k;
+    switch (s->getType()) {
+        case NodeType::MultiStatement:
+            prune((MultiStatementNode*)s, want);
+            return s;
+        //a constant condition picks a branch, or skips the loop. do loops still run once and for loops their start
+        case NodeType::If:
+            if (!d->getExpression() || !IsConst(d->getExpression(), k)) return s;
+            return effect(k ? d->getBody() : ((IfTernaryNode*)s)->getElse(), want, s->getLoc());
+        case NodeType::While:
+            if (!d->getExpression() || !IsConst(d->getExpression(), k) || k) return s;
+            return effect(nullptr, want, s->getLoc());
+        case NodeType::Do:
+            if (!d->getExpression() || !IsConst(d->getExpression(), k) || k) return s;
+            return effect(d->getBody(), want, s->getLoc());
+        case NodeType::For:
+            if (!d->getExpression() || !IsConst(d->getExpression(), k) || k) return s;
+            return effect(((ForNode*)s)->getStart(), want, s->getLoc());
+        default: return s;
+    }
+}
+//runs s for its effect in place of a control statement, which evaluates to 0
+StatementNode *Optimizer::effect(StatementNode *s, bool want, Location l) {
+    if (!want) return s ? s : arena->make<MultiStatementNode>(l);
+    std::vector<StatementNode*> statements;
+    if (s) statements.push_back(s);
+    statements.push_back(number(0, l));
+    return arena->make<MultiStatementNode>(std::move(statements), l);
+}
+//drops statements whose value is unused and that do nothing, and splices nested lists into this one
+void Optimizer::prune(MultiStatementNode *m, bool want) {
+    std::vector<StatementNode*> out;
+    auto &st = m->getStatements();
+    for (size_t i = 0; i < st.size(); i++) {
+        bool used = want && i + 1 == st.size();
+        if (st[i]->getType() == NodeType::MultiStatement && (((MultiStatementNode*)st[i])->getNumStatements() || !used))
+            out.insert(out.end(), ((MultiStatementNode*)st[i])->getStatements().begin(),
+                       ((MultiStatementNode*)st[i])->getStatements().end());
+        else if (used || !Pure(st[i]))
+            out.push_back(st[i]);
+    }
+    st = std::move(out);
+    coalesce(m);
+}
+
+//loop idioms
+//true if s reads the current cell (@#0 or @##0)
+static bool IsCurrentCell(StatementNode *s) {
+    if (!s || s->getType() != NodeType::UnaryOperator) return false;
+    auto *u = (UnaryOperatorNode*)s;
+    return (u->getOp() == ptr_lookupRelUp || u->getOp() == ptr_lookupRelDown) && u->getRHS() &&
+           u->getRHS()->getType() == NodeType::Number && ((NumberNode*)u->getRHS())->getNumber() == 0;
+}
+//flattens a loop body made only of constant +, -, @+ and @- ops
+static bool CollectMoves(StatementNode *s, std::vector<UnaryOperatorNode*> &ops) {
+    if (!s) return true;
+    if (s->getType() == NodeType::MultiStatement) {
+        for (auto st : ((MultiStatementNode*)s)->getStatements())
+            if (!CollectMoves(st, ops)) return false;
+        return true;
+    }
+    if (s->getType() != NodeType::UnaryOperator) return false;
+    auto *u = (UnaryOperatorNode*)s;
+    Operator op = u->getOp();
+    if ((op != addition && op != subtraction && op != ptr_addition && op != ptr_subtraction) ||
+        !u->getRHS() || u->getRHS()->getType() != NodeType::Number)
+        return false;
+    ops.push_back(u);
+    return true;
+}
+StatementNode *Optimizer::idiom(StatementNode *loop) {
+    StatementNode *cond, *start = nullptr;
+    std::vector<UnaryOperatorNode*> ops;
+    if (loop->getType() == NodeType::While) {
+        cond = ((DoWhileNode*)loop)->getExpression();
+        if (!CollectMoves(((DoWhileNode*)loop)->getBody(), ops)) return loop;
+    } else {
+        auto *f = (ForNode*)loop;
+        cond = f->getExpression();
+        start = f->getStart();
+        if (!CollectMoves(f->getBody(), ops) || !CollectMoves(f->getStep(), ops)) return loop;
+    }
+    //the condition must compare the current cell with 0
+    LoopIdiom li;
+    int k;
+    if (IsCurrentCell(cond))
+        li.Cond = notEqual;
+    else if (cond && cond->getType() == NodeType::BinaryOperator && IsCurrentCell(((BinaryOperatorNode*)cond)->getLHS()) &&
+             IsConst(((BinaryOperatorNode*)cond)->getRHS(), k) && k == 0 && (((BinaryOperatorNode*)cond)->getOp() == notEqual ||
+             ((BinaryOperatorNode*)cond)->getOp() == greaterThan || ((BinaryOperatorNode*)cond)->getOp() == lessThan))
+        li.Cond = ((BinaryOperatorNode*)cond)->getOp();
+    else return loop;
+    if (ops.empty()) return loop;
+
+    //walk the body tracking the offset from the loop cell
+    std::vector<std::pair<int, long long>> deltas;
+    long long offset = 0, low = 0;
+    for (auto op : ops) {
+        long long n = ((NumberNode*)op->getRHS())->getNumber();
+        if (op->getOp() == ptr_addition || op->getOp() == ptr_subtraction) {
+            offset += op->getOp() == ptr_addition ? n : -n;
+            if (offset < -(1 << 20) || offset > (1 << 20)) return loop;
+            if (offset < low)
+                li.Lows.emplace_back((int)(low = offset), op->getLoc());
+        } else {
+            auto d = std::find_if(deltas.begin(), deltas.end(), [offset](const std::pair<int, long long> &p) {
+                return p.first == offset; });
+            if (d == deltas.end()) d = deltas.insert(deltas.end(), {(int)offset, 0});
+            d->second += op->getOp() == addition ? n : -n;
+        }
+    }
+    if (ops.size() == 1 && offset != 0) {
+        li.Type = LoopIdiom::Scan;
+        li.Step = (int)offset;
+    } else {
+        if (offset != 0) return loop;
+        long long step = 0;
+        for (auto &d : deltas)
+            if (d.first == 0) step = d.second;
+            else if (wrap(d.second)) li.Adds.emplace_back(d.first, wrap(d.second));
+        //anything else either never ends or counts through the whole int range
+        if (!((step == -1 && li.Cond != lessThan) || (step == 1 && li.Cond != greaterThan))) return loop;
+        li.Step = (int)step;
+        li.Type = li.Adds.empty() && li.Lows.empty() ? LoopIdiom::Clear : LoopIdiom::MulAdd;
+    }
+    StatementNode *node = arena->make<IdiomNode>(std::move(li), loop->getLoc());
+    if (!start) return node;
+    return arena->make<MultiStatementNode>(std::vector<StatementNode*>{start, node}, loop->getLoc());
+}
+StatementNode *Optimizer::idioms(StatementNode *s) {
+    if (!s) return nullptr;
+    MapChildren(s, [this](StatementNode *c) { return idioms(c); });
+    if (s->getType() == NodeType::While || s->getType() == NodeType::For)
+        return idiom(s);
+    return s;
+}
+
+//pointer offsets
+//inside a statement list, constant pointer moves are tracked instead of run: the ops after them address
+//their cells at an offset from the real pointer, which is only moved before statements that need it
+//(anything that reads or moves the pointer, loops, ifs, calls and idioms) and at the end of the list.
+static const int MaxOffset = 1 << 16;
+
+//true if s only uses cells, so it can run with the pointer anywhere once its cell ops are offset
+static bool Relocatable(StatementNode *s) {
+    if (!s) return true;
+    switch (s->getType()) {
+        case NodeType::Number:
+        case NodeType::NullaryOperator:
+            return true;
+        case NodeType::UnaryOperator: {
+            Operator op = ((UnaryOperatorNode*)s)->getOp();
+            return (EnumOps::OpUsesCell(op) || op == ptr_lookup || op == bool_not) &&
+                   Relocatable(((UnaryOperatorNode*)s)->getRHS());
+        }
+        case NodeType::BinaryOperator:
+            return Relocatable(((BinaryOperatorNode*)s)->getLHS()) && Relocatable(((BinaryOperatorNode*)s)->getRHS());
+        case NodeType::Ternary:
+            return Relocatable(((IfTernaryNode*)s)->getExpression()) && Relocatable(((IfTernaryNode*)s)->getBody()) &&
+                   Relocatable(((IfTernaryNode*)s)->getElse());
+        case NodeType::MultiStatement:
+            for (auto st : ((MultiStatementNode*)s)->getStatements())
+                if (!Relocatable(st)) return false;
+            return true;
+        default: return false;
+    }
+}
+static void Shift(StatementNode *s, int offset) {
+    if (!s) return;
+    if ((s->getType() == NodeType::NullaryOperator || s->getType() == NodeType::UnaryOperator) &&
+        EnumOps::OpUsesCell(((NullaryOperatorNode*)s)->getOp()))
+        ((NullaryOperatorNode*)s)->setOffset(((NullaryOperatorNode*)s)->getOffset() + offset);
+    MapChildren(s, [offset](StatementNode *c) { Shift(c, offset); return c; });
+}
+
+StatementNode *Optimizer::offsets(StatementNode *s, bool want) {
+    if (!s) return nullptr;
+    MapUses(s, want, [this](StatementNode *c, bool w) { return offsets(c, w); });
+    if (s->getType() == NodeType::MultiStatement)
+        relocate((MultiStatementNode*)s, want);
+    return s;
+}
+void Optimizer::relocate(MultiStatementNode *m, bool want) {
+    if (m->getNumStatements() < 2) return;
+    std::vector<StatementNode*> out;
+    //the program's pointer is the real pointer + off. when known, the real pointer is base.
+    //off never takes the program's pointer below 0 or below an unknown real pointer, so no offset cell is negative
+    bool known = false, shiftedLast = false, movedLast = false;
+    long long base = 0, off = 0;
+    auto flush = [&](Location l) {
+        if (!off) return;
+        out.push_back(known ? op(ptr_assignment, (int)(base += off), l) : op(ptr_addition, (int)off, l));
+        off = 0;
+    };
+    for (StatementNode *s : m->getStatements()) {
+        Operator o = s->getType() == NodeType::UnaryOperator ? ((UnaryOperatorNode*)s)->getOp() : Operator::null;
+        int k;
+        if ((o == ptr_addition || o == ptr_subtraction || o == ptr_assignment) && IsConst(((UnaryOperatorNode*)s)->getRHS(), k)) {
+            shiftedLast = false;
+            long long next = o == ptr_assignment ? k - base : o == ptr_addition ? off + k : off - k;
+            if ((known || o != ptr_assignment) && next >= -MaxOffset && next <= MaxOffset &&
+                (known ? base + next : next) >= 0 && (!known || base + next <= INT_MAX)) {
+                off = next;
+                movedLast = true;
+                continue;
+            }
+            movedLast = false;
+            //the move runs for real, raising any range error itself
+            if (o != ptr_assignment) flush(s->getLoc());
+            off = 0;
+            out.push_back(s);
+            if (o == ptr_assignment) base = k;
+            else base += o == ptr_addition ? k : -(long long)k;
+            known = (known || o == ptr_assignment) && base >= 0 && base <= INT_MAX;
+        } else if (Relocatable(s)) {
+            Shift(s, (int)off);
+            out.push_back(s);
+            shiftedLast = off != 0;
+            movedLast = false;
+        } else {
+            flush(s->getLoc());
+            out.push_back(s);
+            known = shiftedLast = movedLast = false;
+        }
+    }
+    //the list's value is its last statement's, so that one runs at the real pointer,
+    //and a list ending in moves that cancel out still returns the pointer
+    Location end = m->getStatements().back()->getLoc();
+    if (want && movedLast && !off)
+        out.push_back(known ? op(ptr_assignment, (int)base, end) : op(ptr_addition, 0, end));
+    else if (want && shiftedLast) {
+        StatementNode *last = out.back();
+        out.pop_back();
+        Shift(last, (int)-off);
+        flush(last->getLoc());
+        out.push_back(last);
+    } else flush(end);
+    m->getStatements() = std::move(out);
+}
+
+//dead stores
+//once ops address their cells by offset, a store to a cell that is stored to again before anything reads it
+//does nothing. only lists are scanned, backwards, and anything that moves the real pointer ends the scan.
+
+//removes the offsets s may read from killed
+static void Reads(StatementNode *s, std::vector<int> &killed) {
+    if (!s) return;
+    auto live = [&killed](long long o) { killed.erase(std::remove(killed.begin(), killed.end(), o), killed.end()); };
+    if (s->getType() == NodeType::NullaryOperator || s->getType() == NodeType::UnaryOperator) {
+        Operator op = ((NullaryOperatorNode*)s)->getOp();
+        int o = ((NullaryOperatorNode*)s)->getOffset();
+        StatementNode *rhs = s->getType() == NodeType::UnaryOperator ? ((UnaryOperatorNode*)s)->getRHS() : nullptr;
+        if (op == ptr_lookupRelUp || op == ptr_lookupRelDown) {
+            if (rhs && rhs->getType() != NodeType::Number) killed.clear();
+            else {
+                long long k = rhs ? ((NumberNode*)rhs)->getNumber() : 0;
+                live(op == ptr_lookupRelUp ? o + k : o - k);
+            }
+        } else if (op == ptr_lookup) killed.clear();
+        else if (EnumOps::OpUsesCell(op)) live(o);
+    } else if (s->getType() != NodeType::Number && s->getType() != NodeType::BinaryOperator &&
+               s->getType() != NodeType::Ternary && s->getType() != NodeType::MultiStatement)
+        killed.clear();
+    MapChildren(s, [&killed](StatementNode *c) { Reads(c, killed); return c; });
+}
+StatementNode *Optimizer::deadStores(StatementNode *s, bool want) {
+    if (!s) return nullptr;
+    MapUses(s, want, [this](StatementNode *c, bool w) { return deadStores(c, w); });
+    if (s->getType() != NodeType::MultiStatement) return s;
+    auto &st = ((MultiStatementNode*)s)->getStatements();
+    std::vector<int> killed;      //offsets stored to further down the list before being read
+    std::vector<StatementNode*> out;
+    for (size_t i = st.size(); i-- > 0;) {
+        StatementNode *c = st[i];
+        Operator op = c->getType() == NodeType::UnaryOperator || c->getType() == NodeType::NullaryOperator ?
+                      ((NullaryOperatorNode*)c)->getOp() : Operator::null;
+        if (!Relocatable(c)) killed.clear();
+        else if (op == assignment || op == bit_not || op == Operator::read) {
+            int o = ((NullaryOperatorNode*)c)->getOffset();
+            bool dead = std::find(killed.begin(), killed.end(), o) != killed.end();
+            if (dead && op != Operator::read && !(want && i + 1 == st.size()) && Pure(((UnaryOperatorNode*)c)->getRHS()))
+                continue;
+            if (!dead) killed.push_back(o);
+            if (op != Operator::read) Reads(((UnaryOperatorNode*)c)->getRHS(), killed);
+        } else Reads(c, killed);
+        out.push_back(c);
+    }
+    st.assign(out.rbegin(), out.rend());
+    return s;
+}
@@ -0,0 +1,62 @@
+//
+// Created by 7budd on 10/18/2026.
+//
+#ifndef BRAINPLUS_OPTIMIZER_H
+#define BRAINPLUS_OPTIMIZER_H
+
+#include <vector>
+#include "ASTNodes.h"
+#include "SymbolTable.h"
+
+//AST optimization passes, run on the main code and every function before an engine sees them
+//nodes are rewritten in place; replacement nodes are allocated in the given arena.
+//every rewrite keeps the observable behaviour of the program, including which runtime errors it raises.
+class Optimizer {
+public:
+    struct Inlined {
+        Symbol Id;
+        Location At;            //the call that was replaced
+        unsigned int Size;      //nodes in the function body
+    };
+private:
+    ASTArena *arena;
+    SymbolTable<FunctionNode> *funcs;
+    std::vector<unsigned char> expanded;    //indexed by Symbol: 0 = not yet, 1 = in progress, 2 = done
+    std::vector<Inlined> inlined;
+    static bool IsConst(StatementNode *s, int &k);
+    StatementNode *number(int k, Location l) { return arena->make<NumberNode>(k, l); }
+    StatementNode *op(Operator op, int k, Location l) { return arena->make<UnaryOperatorNode>(op, number(k, l), l); }
+    //inlining
+    StatementNode *clone(StatementNode *s);
+    void expand(FunctionNode *f);
+    StatementNode *inlineCalls(StatementNode *s);
+    //constant folding
+    StatementNode *fold(StatementNode *s);
+    StatementNode *foldUnary(UnaryOperatorNode *s);
+    StatementNode *foldBinary(BinaryOperatorNode *s);
+    //operator-run coalescing
+    StatementNode *merge(StatementNode *a, StatementNode *b);
+    void coalesce(MultiStatementNode *m);
+    //dead code elimination
+    StatementNode *dce(StatementNode *s, bool want);
+    StatementNode *effect(StatementNode *s, bool want, Location l);
+    void prune(MultiStatementNode *m, bool want);
+    StatementNode *deadStores(StatementNode *s, bool want);
+    //loop idiom recognition
+    StatementNode *idiom(StatementNode *loop);
+    StatementNode *idioms(StatementNode *s);
+    //pointer-offset analysis
+    StatementNode *offsets(StatementNode *s, bool want);
+    void relocate(MultiStatementNode *m, bool want);
+public:
+    Optimizer(ASTArena *a, SymbolTable<FunctionNode> *f) : arena(a), funcs(f) {}
+
+    //inlines small functions, optimizes the main code and every function it still calls, and returns the
+    //optimized main code. functions that are no longer called are removed from the table
+    StatementNode *run(StatementNode *code);
+    StatementNode *optimize(StatementNode *s);
+    //every call replaced by run(), in the order they were inlined
+    const std::vector<Inlined> &getInlined() const { return inlined; }
+};
+
+#endif //BRAINPLUS_OPTIMIZER_H
@@ -0,0 +1,153 @@
+//
+// Created by 7budd on 10/18/2026.
+//
+#include "ParseCache.h"
+#include "ASTCodec.h"
+
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <utility>
+#ifdef _WINDOWS
+#include <direct.h>
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#endif
+
+namespace {
+    //bump when the layout of an entry or of the nodes in it changes
+    const char Magic[4] = { 'B', 'P', 'C', '2' };
+
+    std::string hex(uint64_t v) {
+        char buf[17];
+        snprintf(buf, sizeof(buf), "%016llx", (unsigned long long)v);
+        return buf;
+    }
+}
+
+ParseCache::ParseCache(std::string dir) : dir(std::move(dir)) {
+#ifdef _WINDOWS
+    _mkdir(this->dir.c_str());
+#else
+    mkdir(this->dir.c_str(), 0777);
+#endif
+}
+std::string ParseCache::path(uint64_t source) const {
+    return dir + '/' + hex(source) + ".bpc";
+}
+
+bool ParseCache::load(uint64_t source, uint64_t length, Entry &entry) const {
+    std::ifstream in(path(source), std::ios::binary);
+    if (!in) return false;
+    std::stringstream ss;
+    ss << in.rdbuf();
+    std::string data = ss.str();
+    if (data.compare(0, sizeof(Magic), Magic, sizeof(Magic)) != 0) return false;
+    ASTReader r(data.data() + sizeof(Magic), data.data() + data.size());
+    if (r.u64() != source || r.u64() != length) return false;
+    Entry e;
+    e.Dir = r.str();
+    uint32_t n = r.u32();
+    for (uint32_t i = 0; i < n && r.Ok; i++) {
+        Include inc;
+        inc.Id = r.str();
+        inc.Loc = r.loc();
+        inc.Source = r.u64();
+        e.Includes.push_back(std::move(inc));
+    }
+    e.Defines = r.u64();
+    e.DefineData = r.str();
+    e.FunctionData = r.str();
+    if (!r.Ok || !r.done()) return false;
+    entry = std::move(e);
+    return true;
+}
+bool ParseCache::store(uint64_t source, uint64_t length, const Entry &entry) const {
+    ASTWriter w;
+    w.Out.append(Magic, sizeof(Magic));
+    w.u64(source);
+    w.u64(length);
+    w.str(entry.Dir);
+    w.u32(entry.Includes.size());
+    for (auto &inc : entry.Includes) {
+        w.str(inc.Id);
+        w.loc(inc.Loc);
+        w.u64(inc.Source);
+    }
+    w.u64(entry.Defines);
+    w.str(entry.DefineData);
+    w.str(entry.FunctionData);
+    //written beside the entry and renamed over it, so a reader never sees half an entry. the temp name is unique to
+    //this process (a random tag) and store (a counter), since other threads and processes may write the same entry
+    static const std::string process = [] {
+        std::random_device rd;
+        return hex(rd() | (uint64_t)rd() << 32);
+    }();
+    static std::atomic<unsigned int> stores(0);
+    std::string file = path(source), tmp = file + '.' + process + '.' + std::to_string(stores++) + ".tmp";
+    bool ok;
+    {
+        std::ofstream out(tmp, std::ios::binary);
+        ok = (bool)(out << w.Out);
+    }
+#ifdef _WINDOWS
+    ok = ok && MoveFileExA(tmp.c_str(), file.c_str(), MOVEFILE_REPLACE_EXISTING);
+#else
+    ok = ok && rename(tmp.c_str(), file.c_str()) == 0;
+#endif
+    if (!ok) remove(tmp.c_str());
+    return ok;
+}
+
+uint64_t ParseCache::Hash(const char *data, size_t size) {
+    //64-bit FNV-1a
+    uint64_t h = 14695981039346656037ull;
+    for (size_t i = 0; i < size; i++)
+        h = (h ^ (unsigned char)data[i]) * 1099511628211ull;
+    return h;
+}
+uint64_t ParseCache::HashDefines(const SymbolTable<DefineNode> &defines) {
+    uint64_t sum = 0;
+    for (auto def : defines) {
+        //locations only matter for error messages, so they are left out
+        ASTWriter w;
+        w.str(def->getId());
+        for (auto &t : def->getReplacements()) {
+            w.i32(t.Type);
+            w.i32(t.Number);
+            w.i32(t.Op);
+            if (t.Type == TokenType::t_identifier || t.Type == TokenType::t_string)
+                w.str(t.getIdentifier());
+        }
+        sum += Hash(w.Out.data(), w.Out.size());
+    }
+    return sum;
+}
+
+std::string ParseCache::SaveDefines(const std::vector<DefineNode*> &defines) {
+    ASTWriter w;
+    w.defines(defines);
+    return w.Out;
+}
+std::string ParseCache::SaveFunctions(const std::vector<FunctionNode*> &functions) {
+    ASTWriter w;
+    w.functions(functions);
+    return w.Out;
+}
+bool ParseCache::LoadDefines(const std::string &data, ASTArena *arena, std::vector<DefineNode*> &out) {
+    ASTReader r(data.data(), data.data() + data.size());
+    std::vector<DefineNode*> defs;
+    if (!r.defines(arena, defs) || !r.done()) return false;
+    out.insert(out.end(), defs.begin(), defs.end());
+    return true;
+}
+bool ParseCache::LoadFunctions(const std::string &data, ASTArena *arena, std::vector<FunctionNode*> &out) {
+    ASTReader r(data.data(), data.data() + data.size());
+    std::vector<FunctionNode*> funcs;
+    if (!r.functions(arena, funcs) || !r.done()) return false;
+    out.insert(out.end(), funcs.begin(), funcs.end());
+    return true;
+}
@@ -0,0 +1,54 @@
+//
+// Created by 7budd on 10/18/2026.
+//
+#ifndef BRAINPLUS_PARSECACHE_H
+#define BRAINPLUS_PARSECACHE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ASTNodes.h"
+#include "SymbolTable.h"
+
+//On-disk cache of the defines and functions parsed from included files (--cache=DIR)
+//an entry is named after a hash of its file's source text, and records the text's length so a hash collision between
+//files of different lengths isn't taken for a hit. it also records the directory the file was included from and the
+//source hashes of the files it includes, and is only used if all of them still match.
+//a file's defines only depend on its own text, but its function bodies depend on every define in the program,
+//so the functions are only reused if the digest of the define table they were parsed with matches too.
+//nodes are encoded by ASTWriter with names written inline, since interned ids differ between runs.
+class ParseCache {
+    std::string dir;
+    std::string path(uint64_t source) const;
+public:
+    struct Include {
+        std::string Id;     //as parsed: the including file's directory plus the name written
+        Location Loc;
+        uint64_t Source;    //hash of the included file's source, 0 if it wasn't read
+    };
+    struct Entry {
+        std::string Dir;
+        std::vector<Include> Includes;
+        uint64_t Defines;                       //digest of the define table the functions were parsed with
+        std::string DefineData, FunctionData;   //encoded by SaveDefines and SaveFunctions
+    };
+
+    //creates the directory if it doesn't exist
+    explicit ParseCache(std::string dir);
+    //returns false if there is no readable entry for a file with this source hash and length
+    bool load(uint64_t source, uint64_t length, Entry &entry) const;
+    //returns false if the entry could not be written. the cache is only an optimization, so callers may ignore it
+    bool store(uint64_t source, uint64_t length, const Entry &entry) const;
+
+    static uint64_t Hash(const char *data, size_t size);
+    //independent of the order the defines were added in
+    static uint64_t HashDefines(const SymbolTable<DefineNode> &defines);
+    //only node types the parser creates are stored
+    static std::string SaveDefines(const std::vector<DefineNode*> &defines);
+    static std::string SaveFunctions(const std::vector<FunctionNode*> &functions);
+    //nodes are allocated in `arena`. return false, leaving `out` unchanged, if the data is malformed
+    static bool LoadDefines(const std::string &data, ASTArena *arena, std::vector<DefineNode*> &out);
+    static bool LoadFunctions(const std::string &data, ASTArena *arena, std::vector<FunctionNode*> &out);
+};
+
+#endif //BRAINPLUS_PARSECACHE_H
@@ -6,23 +6,11 @@
 #include <utility>
 #include "Parser.h"
 
-//helper finder functions
-DefineNode* GetDefine(const std::string& iden, std::vector<DefineNode*> *defines) {
-    for (DefineNode* node : *defines)
-        if (node->getId() == iden)
-            return node;
-    return nullptr;
-}
-FunctionNode* GetFunction(const std::string& iden, std::vector<FunctionNode*> *funcs) {
-    for (FunctionNode* node : *funcs)
-        if (node->getId() == iden)
-            return node;
-    return nullptr;
-}
 //error logging helper methods
 template <typename T>   //default: StatementNode
 T *Parser::logError(const std::string& msg) {
-    fprintf(stderr, "%s.\n", msg.c_str());
+    if (diagnostics) *diagnostics += msg + ".\n";
+    else fprintf(stderr, "%s.\n", msg.c_str());
     return nullptr;
 }
 
@@ -30,7 +18,7 @@ T *Parser::logError(const std::string& msg) {
 void Parser::checkForDefine() {
     DefineNode *d;
     if (lexer->getCurrentType() == TokenType::t_identifier &&
-        (d = GetDefine(lexer->getCurrentIdentifier(), defines)))
+        (d = defines->find(lexer->getCurrentSymbol())))
         lexer->setReplacement(d->getReplacements());
 }
 IfTernaryNode *Parser::parseIf() {
@@ -47,7 +35,7 @@ IfTernaryNode *Parser::parseIf() {
         lexer->getNextToken(); //eat "else"
         elseBody = parseMultiStatement();
     }
-    return new IfTernaryNode(expr, body, elseBody, false, l);
+    return arena.make<IfTernaryNode>(expr, body, elseBody, false, l);
 }
 IfTernaryNode *Parser::parseTernary(StatementNode *expr) {
     //preconditions: boolean expression has already been parsed, current token is '?'
@@ -57,21 +45,14 @@ IfTernaryNode *Parser::parseTernary(StatementNode *expr) {
     if (!NodeOps::HasNumberReturn(body)) return logError<IfTernaryNode>("IncorrectOperandException: Operand at " +
         body->getLocString() + " must return a number (i.e. be a number, pointer lookup, or ternary)");
     checkForDefine();
-    if (lexer->getCurrentType() != (TokenType)':') {
-        delete body;
+    if (lexer->getCurrentType() != (TokenType)':')
         return logError<IfTernaryNode>("SyntaxException: Expected ':' to separate ternary assignments at " + expr->getLocString());
-    }
     lexer->getNextToken(); //eat ':'
-    if (!(elseBody = parseStatement())) {
-        delete body;
-        return nullptr;
-    }
-    if (!NodeOps::HasNumberReturn(elseBody)) {
-        delete body;
+    if (!(elseBody = parseStatement())) return nullptr;
+    if (!NodeOps::HasNumberReturn(elseBody))
         return logError<IfTernaryNode>("IncorrectOperandException: Operand at " + elseBody->getLocString() +
                                        " must return a number (i.e. be a number, pointer lookup, or ternary)");
-    }
-    return new IfTernaryNode(expr, body, elseBody, true, expr->getLoc());
+    return arena.make<IfTernaryNode>(expr, body, elseBody, true, expr->getLoc());
 }
 ForNode *Parser::parseFor() {
     //precondition: current token is "for"
@@ -82,29 +63,20 @@ ForNode *Parser::parseFor() {
         return logError<ForNode>("SyntaxException: Expected '(' after \"for\" at " + lexer->getCurrentLocString());
     lexer->getNextToken(); //eat '('
     StatementNode *start = parseMultiStatement(true), *expr, *step, *body;
-    if (lexer->getCurrentType() != (TokenType)';') {
-        delete start;
+    if (lexer->getCurrentType() != (TokenType)';')
         return logError<ForNode>("SyntaxException: Expected ';' after for initializer at " + lexer->getCurrentLocString());
-    }
     lexer->getNextToken(); //eat ';'
-    if (!(expr = parseStatement())) {
-        delete start;
-        return nullptr;
-    }
+    if (!(expr = parseStatement())) return nullptr;
     checkForDefine();
-    if (lexer->getCurrentType() != (TokenType)';') {
-        delete start; delete expr;
+    if (lexer->getCurrentType() != (TokenType)';')
         return logError<ForNode>("SyntaxException: Expected ';' after for condition at " + lexer->getCurrentLocString());
-    }
     lexer->getNextToken(); //eat ';'
     step = parseMultiStatement(true);
-    if (lexer->getCurrentType() != (TokenType)')') {
-        delete start; delete expr; delete step;
+    if (lexer->getCurrentType() != (TokenType)')')
         return logError<ForNode>("SyntaxException: Expected ')' after for step at " + lexer->getCurrentLocString());
-    }
     lexer->getNextToken(); //eat ')'
     body = parseMultiStatement();
-    return new ForNode(start, expr, step, body, l);
+    return arena.make<ForNode>(start, expr, step, body, l);
 }
 DoWhileNode *Parser::parseWhile() {
     //precondition: current token is "while"
@@ -116,28 +88,21 @@ DoWhileNode *Parser::parseWhile() {
     StatementNode *expr = parseStatement(), *body;
     if (!expr) return nullptr;
     body = parseMultiStatement();
-    return new DoWhileNode(expr, body, true, l);
+    return arena.make<DoWhileNode>(expr, body, true, l);
 }
 DoWhileNode *Parser::parseDo() {
     //precondition: current token is "do"
     Location l = lexer->getCurrentLocation();
     lexer->getNextToken(); //eat "do"
     StatementNode *expr, *body = parseMultiStatement();
-    if (lexer->getCurrentType() != TokenType::t_while) {
-        delete body;
+    if (lexer->getCurrentType() != TokenType::t_while)
         return logError<DoWhileNode>("SyntaxException: Expected \"while\" after do loop at " + lexer->getCurrentLocString());
-    }
     lexer->getNextToken();
     checkForDefine();
-    if (lexer->getCurrentType() != (TokenType)'(') {
-        delete body;
+    if (lexer->getCurrentType() != (TokenType)'(')
         return logError<DoWhileNode>("SyntaxException: Expected '(' after \"while\" at " + lexer->getCurrentLocString());
-    }
-    if (!(expr = parseStatement())) {
-        delete body;
-        return nullptr;
-    }
-    return new DoWhileNode(expr, body, false, l);
+    if (!(expr = parseStatement())) return nullptr;
+    return arena.make<DoWhileNode>(expr, body, false, l);
 }
 
 StatementNode *Parser::parseOp(int parenDepth) {
@@ -147,31 +112,31 @@ StatementNode *Parser::parseOp(int parenDepth) {
     lexer->getNextToken();
     checkForDefine();
     if (op == Operator::print || op == Operator::read) {
-        return new NullaryOperatorNode(op, l);
+        return arena.make<NullaryOperatorNode>(op, l);
     } else if (lexer->getCurrentType() == (TokenType)'(') {
         lexer->getNextToken();
         if (!(p = parseStatement(parenDepth+1))) return nullptr;
         if (!NodeOps::HasNumberReturn(p)) return logError("IncorrectOperandException: Operand at " +
             p->getLocString() + " must return a number (i.e. be a number, pointer lookup, or ternary)");
         if (EnumOps::OpIsValComp(op))
-            return new BinaryOperatorNode(op, NodeOps::CurrentValLookup(l), p, l);
-        return new UnaryOperatorNode(op, p, l);
+            return arena.make<BinaryOperatorNode>(op, NodeOps::CurrentValLookup(&arena, l), p, l);
+        return arena.make<UnaryOperatorNode>(op, p, l);
     } else if (EnumOps::OpIsValComp(op)) {
         if (lexer->getCurrentType() != TokenType::t_number && (lexer->getCurrentType() != TokenType::t_op ||
                                                                !EnumOps::OpIsPtrLookup(lexer->getCurrentOp())))
             return logError("IncorrectOperandException: Comparative operator at " + l.toString() +
                 " missing right hand-side operand");
         if (!(p = parsePrimary(parenDepth))) return nullptr;
-        return new BinaryOperatorNode(op, NodeOps::CurrentValLookup(l), p, l);
+        return arena.make<BinaryOperatorNode>(op, NodeOps::CurrentValLookup(&arena, l), p, l);
     } else if (lexer->getCurrentType() == TokenType::t_number || op == Operator::bool_not ||
                lexer->getCurrentType() == TokenType::t_op && EnumOps::OpIsPtrLookup(lexer->getCurrentOp())) {
         if (!(p = parsePrimary(parenDepth))) return nullptr;
-        return new UnaryOperatorNode(op, p, l);
+        return arena.make<UnaryOperatorNode>(op, p, l);
     } else if (EnumOps::OpIsPtrLookup(op)) {
-        return NodeOps::CurrentValLookup(l);
+        return NodeOps::CurrentValLookup(&arena, l);
     } else if (op == Operator::assignment || op == Operator::ptr_assignment || op == Operator::ptr_store) {
-        return new UnaryOperatorNode(op, new NumberNode(0, l), l);
-    } else return new UnaryOperatorNode(op, new NumberNode(1, l), l);
+        return arena.make<UnaryOperatorNode>(op, arena.make<NumberNode>(0, l), l);
+    } else return arena.make<UnaryOperatorNode>(op, arena.make<NumberNode>(1, l), l);
 }
 StatementNode *Parser::parsePrimary(int parenDepth) {
     StatementNode *s;
@@ -182,14 +147,14 @@ StatementNode *Parser::parsePrimary(int parenDepth) {
         case t_for:return parseFor();
         case t_while: return parseWhile();
         case t_do: return parseDo();
-        case t_number: s = new NumberNode(lexer->getCurrentToken()->Number, lexer->getCurrentLocation()); break;
+        case t_number: s = arena.make<NumberNode>(lexer->getCurrentToken()->Number, lexer->getCurrentLocation()); break;
         case t_identifier: {
             DefineNode *d;
-            if ((d = GetDefine(lexer->getCurrentIdentifier(), defines))) {
+            if ((d = defines->find(lexer->getCurrentSymbol()))) {
                 lexer->setReplacement(d->getReplacements());
                 return parsePrimary(parenDepth);
-            } else if (!funcComp || GetFunction(lexer->getCurrentIdentifier(), funcs))
-                s = new CallNode(lexer->getCurrentIdentifier(), lexer->getCurrentLocation());
+            } else if (!funcComp || funcs->contains(lexer->getCurrentSymbol()))
+                s = arena.make<CallNode>(lexer->getCurrentSymbol(), lexer->getCurrentLocation());
             else return logError("SyntaxException: Unknown identifier - \"" + lexer->getCurrentIdentifier() +
                 "\" at " + lexer->getCurrentLocString());
             break;
@@ -223,7 +188,7 @@ StatementNode *Parser::parseMultary(int opPrec, StatementNode *lhs) {
         if (lexer->getCurrentType() == TokenType::t_op && curPrec < EnumOps::OpPrecedence(lexer->getCurrentOp())
             && !(rhs = parseMultary(curPrec + 1, rhs)))
             return nullptr;
-        lhs = new BinaryOperatorNode(curOp, lhs, rhs, lhs->getLoc());
+        lhs = arena.make<BinaryOperatorNode>(curOp, lhs, rhs, lhs->getLoc());
     }
     return lhs;
 }
@@ -239,10 +204,7 @@ StatementNode *Parser::parseStatement(int parenDepth) {
         }
         if (parenDepth == 0) return p;
     }
-    if (!(m = parseMultary(0, p))) {
-        delete p;
-        return nullptr;
-    }
+    if (!(m = parseMultary(0, p))) return nullptr;
     if (lexer->getCurrentType() == (TokenType)')' && parenDepth > 0) {
         lexer->getNextToken(); //eat ')'
         parenDepth--;
@@ -257,7 +219,7 @@ StatementNode *Parser::parseMultiStatement(bool forceMulti) {   //default: false
             return parseStatement();
         lexer->getNextToken(); //eat '{'
     }
-    auto* multi = new MultiStatementNode(lexer->getCurrentLocation());
+    auto* multi = arena.make<MultiStatementNode>(lexer->getCurrentLocation());
     StatementNode *stat;
     checkForDefine();
     while (lexer->getCurrentType() != (TokenType)';' && lexer->getCurrentType() != (TokenType)')' &&
@@ -279,11 +241,60 @@ StatementNode *Parser::parseMultiStatement(bool forceMulti) {   //default: false
         s = multi->getStatement(0);
         multi->removeStatement(0);
     } else return multi;
-    delete multi;
     return s;
 }
 
 //public functions
+bool Parser::ExpandDefines(SymbolTable<DefineNode> *defines, std::vector<std::string> &cycle,
+                           unsigned int *expansions) {
+    //depth-first over the define dependency graph with an explicit stack, so long chains can't overflow the call stack.
+    //a define is expanded once everything it refers to is, by copying their already expanded tokens
+    enum { unvisited, expanding, expanded };
+    std::vector<unsigned char> state(Interner::Size(), unvisited);
+    std::vector<std::pair<DefineNode*, unsigned int>> stack;    //define, index of the next token to check
+    cycle.clear();
+    for (auto root : *defines) {
+        if (state[root->getSymbol()] != unvisited) continue;
+        state[root->getSymbol()] = expanding;
+        stack.emplace_back(root, 0);
+        while (!stack.empty()) {
+            DefineNode *def = stack.back().first, *dep = nullptr;
+            unsigned int &i = stack.back().second;
+            for (; i < def->getNumReplacements(); i++) {
+                const Token &t = def->getReplacement(i);
+                if (t.Type == TokenType::t_identifier && (dep = defines->find(t.Id)) &&
+                    state[dep->getSymbol()] != expanded)
+                    break;
+                dep = nullptr;
+            }
+            if (dep && state[dep->getSymbol()] == expanding) {
+                //the cycle is the part of the stack from dep up
+                unsigned int from = 0;
+                while (stack[from].first != dep) from++;
+                for (; from < stack.size(); from++)
+                    cycle.push_back(stack[from].first->getId());
+                cycle.push_back(dep->getId());
+                return false;
+            }
+            if (dep) {
+                state[dep->getSymbol()] = expanding;
+                stack.emplace_back(dep, 0);
+                continue;
+            }
+            std::vector<Token> rep;
+            for (auto &t : def->getReplacements())
+                if (t.Type == TokenType::t_identifier && (dep = defines->find(t.Id))) {
+                    rep.insert(rep.end(), dep->getReplacements().begin(), dep->getReplacements().end());
+                    if (expansions) (*expansions)++;
+                } else rep.push_back(t);
+            def->setReplacements(std::move(rep));
+            state[def->getSymbol()] = expanded;
+            stack.pop_back();
+        }
+    }
+    return true;
+}
+
 IncludeNode* Parser::parseInclude(std::string dir) {
     if (lexer->getCurrentType() != TokenType::t_include)
         return nullptr;
@@ -297,7 +308,7 @@ IncludeNode* Parser::parseInclude(std::string dir) {
     fname += lexer->getCurrentIdentifier();
     Location l = lexer->getCurrentLocation();
     lexer->getNextToken();
-    return new IncludeNode(fname, l);
+    return arena.make<IncludeNode>(fname, l);
 }
 DefineNode* Parser::parseDefine() {
     if (lexer->getCurrentType() != TokenType::t_define) {
@@ -307,18 +318,18 @@ DefineNode* Parser::parseDefine() {
     }
     if (lexer->getNextType() != TokenType::t_identifier)
         return logError<DefineNode>("SyntaxException: Expected identifier for define at " + lexer->getCurrentLocString());
-    if (GetDefine(lexer->getCurrentIdentifier(), defines) != nullptr)
+    if (defines->contains(lexer->getCurrentSymbol()))
         return logError<DefineNode>("MultipleDefinitionException: Define \"" + lexer->getCurrentIdentifier() +
             "\" at " + lexer->getCurrentLocString() + " is already defined");
-    std::string iden = lexer->getCurrentIdentifier();
-    Location l = lexer->getCurrentLocation();
-    auto rep = new std::vector<Token*>();
+    Token iden = *lexer->getCurrentToken();
+    std::vector<Token> rep;
     while (lexer->getNextType() != TokenType::t_define && lexer->getCurrentType() != TokenType::t_enddef)
-        if (lexer->getCurrentType() == TokenType::t_identifier && lexer->getCurrentIdentifier() == iden)
-            return logError<DefineNode>("RecursiveDefineException: Define \"" + iden + "\" contains a reference to itself");
+        if (lexer->getCurrentType() == TokenType::t_identifier && lexer->getCurrentSymbol() == iden.Id)
+            return logError<DefineNode>("RecursiveDefineException: Define \"" + iden.getIdentifier() +
+                "\" contains a reference to itself");
         else
-            rep->push_back(new Token(lexer->getCurrentToken()));
-    return new DefineNode(iden, rep, l);
+            rep.push_back(*lexer->getCurrentToken());
+    return arena.make<DefineNode>(iden.Id, std::move(rep), iden.Loc);
 }
 FunctionNode* Parser::parseFunction() {
     if (lexer->getCurrentType() != TokenType::t_identifier) {
@@ -326,7 +337,8 @@ FunctionNode* Parser::parseFunction() {
         return nullptr;
     }
     //save identifier token in case code starts with identifier and we need to back up the lexer
-    auto *iden = new Token(lexer->getCurrentToken());
+    Token iden = *lexer->getCurrentToken();
+    iden.Loc = lexer->getCurrentLocation();
     checkForDefine();
     if (lexer->getNextType() != (TokenType)'{') {
         //back up lexer to previous identifier token
@@ -334,22 +346,18 @@ FunctionNode* Parser::parseFunction() {
         funcComp = true;
         return nullptr;
     }
-    if (GetDefine(lexer->getCurrentIdentifier(), defines) != nullptr) {
-        delete iden;
+    if (defines->contains(iden.Id)) {
         funcComp = true;
-        return logError<FunctionNode>("MultipleDefinitionException: Function \"" + lexer->getCurrentIdentifier() +
+        return logError<FunctionNode>("MultipleDefinitionException: Function \"" + iden.getIdentifier() +
                                       "\" overwrites a define with the same name");
     }
-    if (GetFunction(lexer->getCurrentIdentifier(), funcs) != nullptr) {
-        delete iden;
+    if (funcs->contains(iden.Id)) {
         funcComp = true;
-        return logError<FunctionNode>("MultipleDefinitionException: Function \"" + lexer->getCurrentIdentifier() +
-                                      "\" at " + lexer->getCurrentLocString() + " is previously defined");
+        return logError<FunctionNode>("MultipleDefinitionException: Function \"" + iden.getIdentifier() +
+                                      "\" at " + iden.Loc.toString() + " is previously defined");
     }
     StatementNode* body = parseMultiStatement();
-    auto *func = new FunctionNode(iden->Identifier, body, iden->Loc);
-    delete iden;
-    return func;
+    return arena.make<FunctionNode>(iden.Id, body, iden.Loc);
 }
 StatementNode* Parser::parseCode() {
     return parseMultiStatement(true);
@@ -8,19 +8,18 @@
 
 #include "Lexer.h"
 #include "ASTNodes.h"
-
-//helper find functions
-DefineNode* GetDefine(const std::string& iden, std::vector<DefineNode*> *defines);
-FunctionNode* GetFunction(const std::string& iden, std::vector<FunctionNode*> *funcs);
+#include "SymbolTable.h"
 
 class Parser {
     Lexer *lexer;
-    std::vector<DefineNode*>* defines;
-    std::vector<FunctionNode*>* funcs;
+    ASTArena arena;     //owns every node parsed from this file
+    SymbolTable<DefineNode>* defines;
+    SymbolTable<FunctionNode>* funcs;
     bool funcComp;
+    std::string *diagnostics;   //if set, errors are appended here instead of printed
     // error logging helper function
     template <typename T = StatementNode>
-    static T *logError(const std::string& msg);
+    T *logError(const std::string& msg);
     //parsing helper functions
     void checkForDefine();
     IfTernaryNode *parseIf();
@@ -35,13 +34,28 @@ class Parser {
     StatementNode *parseStatement(int parenDepth = 0);
     StatementNode *parseMultiStatement(bool forceMulti = false);
 public:
-    explicit Parser(Lexer *l, std::vector<DefineNode*>* d, std::vector<FunctionNode*>* f) :
-        lexer(l), defines(d), funcs(f), funcComp(false) {
-        if (!lexer->good()) throw std::exception(("IOException: " + lexer->getFileName() + " not good").c_str());
+    explicit Parser(Lexer *l, SymbolTable<DefineNode>* d, SymbolTable<FunctionNode>* f) :
+        lexer(l), defines(d), funcs(f), funcComp(false), diagnostics(nullptr) {
+        if (lexer && !lexer->good()) throw std::exception(("IOException: " + lexer->getFileName() + " not good").c_str());
     }
     ~Parser() { delete lexer; }
 
-    bool good() { return lexer->good(); }
+    //substitutes defines referenced by other defines, dependencies first, so each define is expanded once and
+    //ends up with no references to other defines. linear in the size of the expanded defines.
+    //returns false and fills `cycle` with the defines on a cycle, in order, the first repeated at the end
+    //adds the number of substitutions made to `expansions`
+    static bool ExpandDefines(SymbolTable<DefineNode> *defines, std::vector<std::string> &cycle,
+                              unsigned int *expansions = nullptr);
+
+    bool good() { return lexer && lexer->good(); }
+    ASTArena *getArena() { return &arena; }
+    Lexer *getLexer() { return lexer; }
+    //for parsing on another thread: definitions go to tables private to this file until they are merged,
+    //and errors are kept until they can be printed in a deterministic order
+    void setTables(SymbolTable<DefineNode>* d, SymbolTable<FunctionNode>* f) { defines = d; funcs = f; }
+    void collectErrors(std::string *out) { diagnostics = out; }
+    //a parser made without a lexer only owns nodes loaded from a ParseCache, until its file has to be parsed after all
+    void setLexer(Lexer *l) { lexer = l; }
     IncludeNode* parseInclude(std::string dir);
     DefineNode* parseDefine();
     FunctionNode* parseFunction();
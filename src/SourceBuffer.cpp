@@ -0,0 +1,88 @@
+//
+// Created by 7budd on 10/17/2026.
+//
+#include "SourceBuffer.h"
+
+#include <cstdio>
+#include <cstring>
+#ifdef _WINDOWS
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+SourceBuffer::SourceBuffer(const std::string& filename, bool tryMap) :
+    data(""), size(0), mapped(false), valid(false), heap(nullptr), mapHandle(nullptr) {
+    valid = (tryMap && map(filename)) || load(filename);
+}
+SourceBuffer::~SourceBuffer() {
+    if (mapped) {
+#ifdef _WINDOWS
+        UnmapViewOfFile(data);
+        CloseHandle((HANDLE)mapHandle);
+#else
+        munmap((void*)data, size);
+#endif
+    }
+    delete[] heap;
+}
+
+bool SourceBuffer::map(const std::string& filename) {
+#ifdef _WINDOWS
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER fsize;
+    if (!GetFileSizeEx(file, &fsize) || fsize.QuadPart == 0) {
+        CloseHandle(file);
+        return false;   //empty files cannot be mapped, let the fallback handle them
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping) return false;
+    void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(mapping);
+        return false;
+    }
+    mapHandle = mapping;
+    size = (size_t)fsize.QuadPart;
+#else
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+        close(fd);
+        return false;   //empty files cannot be mapped, let the fallback handle them
+    }
+    void *view = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED) return false;
+    madvise(view, (size_t)st.st_size, MADV_SEQUENTIAL);
+    size = (size_t)st.st_size;
+#endif
+    data = (const char*)view;
+    mapped = true;
+    return true;
+}
+bool SourceBuffer::load(const std::string& filename) {
+    FILE *file = fopen(filename.c_str(), "rb");
+    if (!file) return false;
+    size_t cap = 1 << 16, len = 0, n;
+    heap = new char[cap];
+    while ((n = fread(heap + len, 1, cap - len, file)) > 0)
+        if ((len += n) == cap) {
+            char *grown = new char[cap *= 2];
+            memcpy(grown, heap, len);
+            delete[] heap;
+            heap = grown;
+        }
+    bool ok = !ferror(file);
+    fclose(file);
+    data = heap;
+    size = len;
+    return ok;
+}
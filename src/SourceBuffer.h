@@ -0,0 +1,34 @@
+//
+// Created by 7budd on 10/17/2026.
+//
+#ifndef BRAINPLUS_SOURCEBUFFER_H
+#define BRAINPLUS_SOURCEBUFFER_H
+
+#include <string>
+#include <cstddef>
+
+//Read-only view of an entire source file.
+//The file is memory-mapped when possible, otherwise it is read into a heap buffer.
+//Either way the lexer walks the characters in [begin(), end()) directly.
+class SourceBuffer {
+    const char *data;
+    size_t size;
+    bool mapped, valid;
+    char *heap;         //only used by the read-into-buffer fallback
+    void *mapHandle;    //only used on windows
+    bool map(const std::string& filename);
+    bool load(const std::string& filename);
+public:
+    explicit SourceBuffer(const std::string& filename, bool tryMap = true);
+    ~SourceBuffer();
+    SourceBuffer(const SourceBuffer&) = delete;
+    SourceBuffer &operator=(const SourceBuffer&) = delete;
+
+    const char *begin() const { return data; }
+    const char *end() const { return data + size; }
+    size_t length() const { return size; }
+    bool good() const { return valid; }
+    bool isMapped() const { return mapped; }
+};
+
+#endif //BRAINPLUS_SOURCEBUFFER_H
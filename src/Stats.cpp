@@ -0,0 +1,120 @@
+//
+// Created by 7budd on 10/18/2026.
+//
+#include "Stats.h"
+
+#include <cstdio>
+#ifdef _WINDOWS
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+void Stats::begin(const std::string& name, Counters now) {
+    phases.push_back({name, 0, 0, {0, 0, 0}, 0});
+    workStart = now;
+    cpuStart = ProcessCpuMs();
+    wallStart = std::chrono::steady_clock::now();
+}
+void Stats::end(Counters now) {
+    Phase &p = phases.back();
+    p.WallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wallStart).count();
+    p.CpuMs = ProcessCpuMs() - cpuStart;
+    p.Work = {now.Tokens - workStart.Tokens, now.Nodes - workStart.Nodes, now.Expansions - workStart.Expansions};
+    p.PeakKiB = PeakMemoryKiB();
+}
+
+size_t Stats::PeakMemoryKiB() {
+#ifdef _WINDOWS
+    PROCESS_MEMORY_COUNTERS mem;
+    return GetProcessMemoryInfo(GetCurrentProcess(), &mem, sizeof(mem)) ? mem.PeakWorkingSetSize / 1024 : 0;
+#else
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;     //bytes on macOS
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+}
+double Stats::ProcessCpuMs() {
+#ifdef _WINDOWS
+    //not clock(), which is wall time on Windows
+    FILETIME created, exited, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user)) return 0;
+    ULARGE_INTEGER k, u;
+    k.LowPart = kernel.dwLowDateTime;
+    k.HighPart = kernel.dwHighDateTime;
+    u.LowPart = user.dwLowDateTime;
+    u.HighPart = user.dwHighDateTime;
+    return (double)(k.QuadPart + u.QuadPart) / 10000;     //100 ns units
+#else
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000.0 +
+           (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000.0;
+#endif
+}
+
+static std::string fixed(double v) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.3f", v);
+    return buf;
+}
+static std::string pad(std::string s, unsigned int width, bool left = false) {
+    if (s.size() < width) s = left ? s + std::string(width - s.size(), ' ') : std::string(width - s.size(), ' ') + s;
+    return s;
+}
+static std::string quote(const std::string& s) {
+    std::string str = "\"";
+    for (char c : s)
+        if (c == '"' || c == '\\') str += std::string("\\") + c;
+        else if ((unsigned char)c < 0x20) {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", c);
+            str += buf;
+        } else str += c;
+    return str + '"';
+}
+
+std::string Stats::toText() const {
+    double wall = 0, cpu = 0;
+    std::string str = pad("phase", 12, true) + pad("wall ms", 12) + pad("cpu ms", 12) + pad("tokens", 10) +
+                      pad("nodes", 10) + pad("expansions", 12) + pad("peak KiB", 11) + '\n';
+    for (auto &p : phases) {
+        str += pad(p.Name, 12, true) + pad(fixed(p.WallMs), 12) + pad(fixed(p.CpuMs), 12) +
+               pad(std::to_string(p.Work.Tokens), 10) + pad(std::to_string(p.Work.Nodes), 10) +
+               pad(std::to_string(p.Work.Expansions), 12) + pad(std::to_string(p.PeakKiB), 11) + '\n';
+        wall += p.WallMs;
+        cpu += p.CpuMs;
+    }
+    str += pad("total", 12, true) + pad(fixed(wall), 12) + pad(fixed(cpu), 12) + '\n';
+    str += '\n' + pad("file", 40, true) + pad("bytes", 10) + pad("lex ms", 10) + pad("tokens", 10) +
+           pad("nodes", 10) + pad("expansions", 12) + '\n';
+    for (auto &f : files)
+        str += pad(f.Name, 40, true) + pad(std::to_string(f.Bytes), 10) + pad(fixed(f.LexMs), 10) +
+               pad(std::to_string(f.Work.Tokens), 10) + pad(std::to_string(f.Work.Nodes), 10) +
+               pad(std::to_string(f.Work.Expansions), 12) + '\n';
+    return str;
+}
+std::string Stats::toJson() const {
+    std::string str = "{\"phases\": [";
+    for (unsigned int i = 0; i < phases.size(); i++) {
+        const Phase &p = phases[i];
+        str += std::string(i ? ",\n" : "\n") + "  {\"name\": " + quote(p.Name) + ", \"wall_ms\": " + fixed(p.WallMs) +
+               ", \"cpu_ms\": " + fixed(p.CpuMs) + ", \"tokens\": " + std::to_string(p.Work.Tokens) +
+               ", \"nodes\": " + std::to_string(p.Work.Nodes) + ", \"expansions\": " +
+               std::to_string(p.Work.Expansions) + ", \"peak_kib\": " + std::to_string(p.PeakKiB) + "}";
+    }
+    str += "\n], \"files\": [";
+    for (unsigned int i = 0; i < files.size(); i++) {
+        const File &f = files[i];
+        str += std::string(i ? ",\n" : "\n") + "  {\"name\": " + quote(f.Name) + ", \"bytes\": " +
+               std::to_string(f.Bytes) + ", \"lex_ms\": " + fixed(f.LexMs) + ", \"tokens\": " +
+               std::to_string(f.Work.Tokens) + ", \"nodes\": " + std::to_string(f.Work.Nodes) +
+               ", \"expansions\": " + std::to_string(f.Work.Expansions) + "}";
+    }
+    return str + "\n]}\n";
+}
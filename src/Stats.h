@@ -0,0 +1,53 @@
+//
+// Created by 7budd on 10/18/2026.
+//
+#ifndef BRAINPLUS_STATS_H
+#define BRAINPLUS_STATS_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+//Measurements behind --stats: wall time, CPU time, work done and peak memory for each phase of a run,
+//and the work done on each source file
+//work counters are running totals read by the caller; a phase records how much they grew between begin and end.
+//peak memory is the process high-water mark when the phase ended.
+class Stats {
+public:
+    struct Counters {
+        unsigned long long Tokens;      //lexed
+        unsigned long long Nodes;       //allocated in the AST arenas
+        unsigned long long Expansions;  //define substitutions
+    };
+    struct Phase {
+        std::string Name;
+        double WallMs, CpuMs;
+        Counters Work;
+        size_t PeakKiB;
+    };
+    struct File {
+        std::string Name;
+        size_t Bytes;
+        double LexMs;
+        Counters Work;
+    };
+private:
+    std::vector<Phase> phases;
+    std::vector<File> files;
+    std::chrono::steady_clock::time_point wallStart;
+    double cpuStart;
+    Counters workStart;
+public:
+    void begin(const std::string& name, Counters now);
+    void end(Counters now);
+    void addFile(const File& f) { files.push_back(f); }
+
+    std::string toText() const;
+    std::string toJson() const;
+    //process peak resident memory so far, 0 where unknown
+    static size_t PeakMemoryKiB();
+    //CPU time (user and kernel) used by all threads of the process so far, 0 where unknown
+    static double ProcessCpuMs();
+};
+
+#endif //BRAINPLUS_STATS_H
@@ -0,0 +1,48 @@
+//
+// Created by 7budd on 10/17/2026.
+//
+#ifndef BRAINPLUS_SYMBOLTABLE_H
+#define BRAINPLUS_SYMBOLTABLE_H
+
+#include <algorithm>
+#include <vector>
+#include "Interner.h"
+
+//table of named nodes (defines, functions) with O(1) lookup by interned symbol
+//nodes are indexed directly by their Symbol; the insertion-ordered list is only kept for iteration
+template <typename T>
+class SymbolTable {
+    std::vector<T*> nodes;
+    std::vector<T*> index;
+public:
+    T *find(Symbol id) const { return id < index.size() ? index[id] : nullptr; }
+    bool contains(Symbol id) const { return find(id) != nullptr; }
+    //returns false and leaves the table unchanged if the name is already taken
+    bool insert(T *node) {
+        Symbol id = node->getSymbol();
+        if (contains(id)) return false;
+        //only as large as the highest symbol inserted; each file has its own table, so sizing every one to the whole
+        //interner would cost files x symbols
+        if (id >= index.size())
+            index.resize(id + 1, nullptr);
+        index[id] = node;
+        nodes.push_back(node);
+        return true;
+    }
+    //returns false if there is no node with this name
+    bool erase(Symbol id) {
+        T *node = find(id);
+        if (!node) return false;
+        index[id] = nullptr;
+        nodes.erase(std::find(nodes.begin(), nodes.end(), node));
+        return true;
+    }
+
+    unsigned int size() const { return nodes.size(); }
+    bool empty() const { return nodes.empty(); }
+    T *at(unsigned int i) const { return nodes.at(i); }
+    typename std::vector<T*>::const_iterator begin() const { return nodes.begin(); }
+    typename std::vector<T*>::const_iterator end() const { return nodes.end(); }
+};
+
+#endif //BRAINPLUS_SYMBOLTABLE_H
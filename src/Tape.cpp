@@ -0,0 +1,102 @@
+//
+// Created by 7budd on 10/18/2026.
+//
+#include "Tape.h"
+
+#include <new>
+
+#ifdef _WINDOWS
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+const size_t Tape::MaxCells, Tape::GuardBytes, Tape::PageCells;
+
+Tape::Tape(Mode m) : mode(m), cells(nullptr), reserved(0), size(0), dir(nullptr), pages(0), lastPage(-1),
+                     lastCells(nullptr) {
+    if (mode == Sparse) {
+        size = MaxCells;
+        return;
+    }
+    for (size_t n = MaxCells; n >= (1 << 16) && !cells; n /= 2) {
+        size_t bytes = n * sizeof(int) + GuardBytes;
+#ifdef _WINDOWS
+        void *mem = VirtualAlloc(nullptr, bytes, MEM_RESERVE, PAGE_NOACCESS);
+        if (!mem) continue;
+#else
+        int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#ifdef MAP_NORESERVE
+        flags |= MAP_NORESERVE;
+#endif
+        void *mem = mmap(nullptr, bytes, PROT_NONE, flags, -1, 0);
+        if (mem == MAP_FAILED) continue;
+        //the guard pages after the cells stay PROT_NONE
+        if (mprotect(mem, n * sizeof(int), PROT_READ | PROT_WRITE) != 0) {
+            munmap(mem, bytes);
+            continue;
+        }
+        size = n;
+#endif
+        cells = (int*)mem;
+        reserved = n;
+    }
+}
+Tape::~Tape() {
+    if (dir) {
+        for (size_t hi = 0; hi < (1 << DirBits); hi++) {
+            if (!dir[hi]) continue;
+            for (size_t mid = 0; mid < (1 << TableBits); mid++)
+                delete[] dir[hi][mid];
+            delete[] dir[hi];
+        }
+        delete[] dir;
+    }
+    if (!cells) return;
+#ifdef _WINDOWS
+    VirtualFree(cells, 0, MEM_RELEASE);
+#else
+    munmap(cells, reserved * sizeof(int) + GuardBytes);
+#endif
+}
+
+bool Tape::grow(size_t addr) {
+    if (addr < size) return true;
+    if (mode == Sparse || addr >= reserved) return false;
+#ifdef _WINDOWS
+    //commit at least double what is committed, in 64K-cell chunks, never past the region
+    size_t n = addr + 1 > size * 2 ? addr + 1 : size * 2;
+    n = (n + 0xFFFF) & ~(size_t)0xFFFF;
+    if (n > reserved) n = reserved;
+    if (!VirtualAlloc(cells + size, (n - size) * sizeof(int), MEM_COMMIT, PAGE_READWRITE))
+        return false;
+    size = n;
+    return true;
+#else
+    return false;
+#endif
+}
+
+int *Tape::page(size_t addr) {
+    if (addr >= MaxCells) return nullptr;
+    size_t hi = addr >> (TableBits + PageBits), mid = (addr >> PageBits) & ((1 << TableBits) - 1);
+    if (!dir && !(dir = new (std::nothrow) int**[1 << DirBits]())) return nullptr;
+    if (!dir[hi] && !(dir[hi] = new (std::nothrow) int*[1 << TableBits]())) return nullptr;
+    int *&p = dir[hi][mid];
+    if (!p) {
+        if (!(p = new (std::nothrow) int[PageCells]())) return nullptr;
+        pages++;
+    }
+    lastPage = addr >> PageBits;
+    lastCells = p;
+    return p;
+}
+
+int Tape::get(int addr) const {
+    if (addr < 0 || (size_t)addr >= size) return 0;
+    if (mode == Dense) return cells[addr];
+    if (!dir) return 0;
+    int **table = dir[(size_t)addr >> (TableBits + PageBits)];
+    int *p = table ? table[((size_t)addr >> PageBits) & ((1 << TableBits) - 1)] : nullptr;
+    return p ? p[addr & (PageCells - 1)] : 0;
+}
@@ -0,0 +1,65 @@
+//
+// Created by 7budd on 10/18/2026.
+//
+#ifndef BRAINPLUS_TAPE_H
+#define BRAINPLUS_TAPE_H
+
+#include <cstddef>
+
+//The machine's cells, shared by every engine. either mode addresses cells 0 to MaxCells - 1.
+//Dense: cells live in one reserved virtual region that never moves, so engines can keep raw pointers into it while
+//it grows. On POSIX the whole region is mapped at once and the OS only backs a page with memory when it is first
+//touched; on Windows the region is reserved and committed in chunks as the tape grows.
+//Inaccessible guard pages follow the region, so a stray access past the end faults instead of touching other memory.
+//If the address space can't be reserved, smaller regions are tried.
+//Sparse: cells live in pages of PageCells found through a two-level page table and allocated on first access,
+//for programs that touch a few cells spread over a huge range. there is no contiguous data(), so engines that
+//need raw pointers (the JIT) can't use it. the last page used is cached, so runs of nearby accesses skip the table.
+class Tape {
+public:
+    enum Mode { Dense, Sparse };
+    static const size_t MaxCells = (size_t)1 << 31;    //every non-negative int address
+    static const size_t GuardBytes = 1 << 20;          //more than the largest cell offset the Optimizer uses
+    static const unsigned int PageBits = 10, TableBits = 11;
+    static const size_t PageCells = (size_t)1 << PageBits;
+private:
+    static const unsigned int DirBits = 31 - TableBits - PageBits;
+    Mode mode;
+    int *cells;
+    size_t reserved;    //cells in the region
+    size_t size;        //cells usable without calling grow()
+    int ***dir;         //sparse page table: dir[hi][mid] is the page for cells (hi, mid, *)
+    size_t pages;
+    size_t lastPage;
+    int *lastCells;
+    int *page(size_t addr);     //finds or allocates the sparse page holding addr
+public:
+    explicit Tape(Mode m = Dense);
+    ~Tape();
+    Tape(const Tape&) = delete;
+    Tape &operator=(const Tape&) = delete;
+
+    Mode getMode() const { return mode; }
+    //dense only; null for a sparse tape
+    int *data() const { return cells; }
+    size_t getSize() const { return size; }
+    //dense: makes cells [0, addr] usable. false if addr is past the reserved region or memory can't be committed.
+    //sparse: false if addr is past MaxCells
+    bool grow(size_t addr);
+    //dense only
+    int &operator[](size_t addr) { return cells[addr]; }
+    //the cell at addr in either mode, or null if it is out of range or memory runs out
+    int *cell(size_t addr) {
+        if (mode == Dense) return addr < size || grow(addr) ? cells + addr : nullptr;
+        if (addr >> PageBits == lastPage) return lastCells + (addr & (PageCells - 1));
+        int *p = page(addr);
+        return p ? p + (addr & (PageCells - 1)) : nullptr;
+    }
+    //reads never allocate; cells that were never touched are 0
+    int get(int addr) const;
+
+    //sparse pages allocated so far, i.e. pages with a cell that was written or used as a current cell
+    size_t getPages() const { return pages; }
+};
+
+#endif //BRAINPLUS_TAPE_H
@@ -0,0 +1,100 @@
+//
+// Created by 7budd on 10/18/2026.
+//
+#include "ThreadPool.h"
+
+namespace {
+    //which pool and queue the current thread works for, if any
+    thread_local const ThreadPool *currentPool = nullptr;
+    thread_local unsigned int currentQueue = 0;
+}
+
+ThreadPool::ThreadPool(unsigned int threads) : queued(0), pending(0), next(0), stop(false) {
+    if (threads == 0) threads = 1;
+    for (unsigned int i = 0; i < threads; i++)
+        queues.emplace_back(new Queue());
+    for (unsigned int i = 0; i < threads; i++)
+        workers.emplace_back(&ThreadPool::work, this, i);
+}
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> l(lock);
+        stop = true;
+    }
+    wake.notify_all();
+    for (auto &w : workers)
+        w.join();
+}
+
+unsigned int ThreadPool::DefaultThreads() {
+    unsigned int n = std::thread::hardware_concurrency();
+    return n ? n : 4;
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> l(lock);
+        unsigned int q = currentPool == this ? currentQueue : next++ % queues.size();
+        pending++;
+        {
+            std::lock_guard<std::mutex> ql(queues[q]->lock);
+            queues[q]->tasks.push_back(std::move(task));
+        }
+        //counted once it is visible, so a woken worker always finds it. a worker taking it right away can't
+        //uncount it before this, since that needs the pool lock
+        queued++;
+    }
+    wake.notify_one();
+}
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> l(lock);
+    idle.wait(l, [this] { return pending == 0; });
+    if (error) {
+        std::exception_ptr e = error;
+        error = nullptr;
+        std::rethrow_exception(e);
+    }
+}
+
+bool ThreadPool::take(unsigned int self, std::function<void()> &task) {
+    for (unsigned int i = 0; i < queues.size(); i++) {
+        Queue &q = *queues[(self + i) % queues.size()];
+        std::lock_guard<std::mutex> l(q.lock);
+        if (q.tasks.empty()) continue;
+        if (i == 0) {
+            task = std::move(q.tasks.back());
+            q.tasks.pop_back();
+        } else {
+            task = std::move(q.tasks.front());
+            q.tasks.pop_front();
+        }
+        return true;
+    }
+    return false;
+}
+void ThreadPool::work(unsigned int self) {
+    currentPool = this;
+    currentQueue = self;
+    for (;;) {
+        std::function<void()> task;
+        if (take(self, task)) {
+            {
+                std::lock_guard<std::mutex> l(lock);
+                queued--;
+            }
+            std::exception_ptr e;
+            try {
+                task();
+            } catch (...) {
+                e = std::current_exception();
+            }
+            std::lock_guard<std::mutex> l(lock);
+            if (e && !error) error = e;
+            if (--pending == 0) idle.notify_all();
+            continue;
+        }
+        std::unique_lock<std::mutex> l(lock);
+        wake.wait(l, [this] { return stop || queued > 0; });
+        if (stop && queued == 0) return;
+    }
+}
@@ -0,0 +1,48 @@
+//
+// Created by 7budd on 10/18/2026.
+//
+#ifndef BRAINPLUS_THREADPOOL_H
+#define BRAINPLUS_THREADPOOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//Work-stealing pool of worker threads
+//every worker has its own deque of tasks. tasks submitted from a worker go to the back of its own deque and it
+//takes from the back, so work a task spawns (files found while parsing an include) stays on the same thread;
+//a worker with nothing left steals from the front of the others'.
+//the first exception a task throws is rethrown by wait().
+class ThreadPool {
+    struct Queue {
+        std::mutex lock;
+        std::deque<std::function<void()>> tasks;
+    };
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::mutex lock;
+    std::condition_variable wake, idle;
+    size_t queued, pending;     //tasks not taken yet, tasks not finished yet
+    unsigned int next;          //queue for the next task submitted from outside the pool
+    bool stop;
+    std::exception_ptr error;
+    bool take(unsigned int self, std::function<void()> &task);
+    void work(unsigned int self);
+public:
+    explicit ThreadPool(unsigned int threads = DefaultThreads());
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool &operator=(const ThreadPool&) = delete;
+
+    void submit(std::function<void()> task);
+    //blocks until every task, including ones submitted by other tasks, has finished. not callable from a task
+    void wait();
+    static unsigned int DefaultThreads();
+};
+
+#endif //BRAINPLUS_THREADPOOL_H
@@ -0,0 +1,196 @@
+//
+// Created by 7budd on 10/18/2026.
+//
+#include "VM.h"
+#include "Arith.h"
+#include "CallStack.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+#include <new>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define VM_COMPUTED_GOTO
+#endif
+
+int VM::run(const Bytecode *prog) {
+    return tape.getMode() == Tape::Sparse ? exec<true>(prog) : exec<false>(prog);
+}
+
+template <bool Sparse>
+int VM::exec(const Bytecode *prog) {
+    struct Frame { const Instr *Ret; size_t Base; };
+    std::vector<Frame> frames;
+    const Instr *code = prog->Code.data(), *ip = code + prog->Functions[0].Entry;
+    if (regs.size() < (size_t)prog->Functions[0].Frame)
+        regs.resize(prog->Functions[0].Frame, 0);
+    int *r = regs.data();
+    int *t = tape.data(), *cp = nullptr;        //the tape never moves, only its size changes. unused when sparse
+    size_t size = tape.getSize(), reach = prog->Reach;
+    int p = ptr;
+
+    auto fail = [&](const std::string& msg) {
+        ptr = p;
+        throw std::exception(("RuntimeException: " + msg + " at " + prog->Locs[ip - code].toString()).c_str());
+    };
+    auto grow = [&](int addr) {
+        if (addr < 0) fail("Cell " + std::to_string(addr) + " is out of range");
+        if (!tape.grow(addr)) fail("Out of memory");
+        size = tape.getSize();
+        cp = t + p;
+    };
+    //cell in range. a sparse tape may still have to allocate its page
+    auto cell = [&](int addr) -> int& {
+        if (!Sparse) return t[addr];
+        int *c = tape.cell(addr);
+        if (!c) fail("Out of memory");
+        return *c;
+    };
+    //checked access for computed addresses
+    auto at = [&](int addr) -> int& {
+        if ((unsigned int)addr >= size) grow(addr);
+        return cell(addr);
+    };
+    //keeps 0 <= p and p + reach < size after every pointer update, so cells at offsets up to the reach
+    //can be used unchecked. negative offsets are only used where the Optimizer proved p + C >= 0
+#define MOVED() \
+    do { \
+        if ((unsigned int)p + reach >= size) { \
+            if (p < 0) fail("Pointer moved out of range to " + std::to_string(p)); \
+            grow(p + (int)reach); \
+        } \
+        if (!Sparse) cp = t + p; \
+    } while (0)
+#define CELL (Sparse ? cell(p + ip->C) : cp[ip->C])
+
+    if (p < 0) p = 0;
+    MOVED();
+
+#ifdef VM_COMPUTED_GOTO
+#define BYTECODE_LABEL(op) &&L_##op,
+    static void *labels[] = { BYTECODE_OPS(BYTECODE_LABEL) };
+#undef BYTECODE_LABEL
+#define CASE(op) L_##op:
+#define NEXT goto *labels[ip->Op]
+    NEXT;
+#else
+#define CASE(op) case op:
+#define NEXT continue
+    for (;;) switch (ip->Op) {
+#endif
+    CASE(bc_halt) goto done;
+    CASE(bc_ret) {
+        Frame f = frames.back();
+        frames.pop_back();
+        r = regs.data() + f.Base;
+        ip = f.Ret;
+        NEXT;
+    }
+    CASE(bc_call) {
+        const Bytecode::Function &f = prog->Functions[ip->B];
+        if (frames.size() == (size_t)CallStack::MaxDepth) fail(CallStack::Overflow);
+        size_t base = (r - regs.data()) + ip->A;
+        frames.push_back({ip + 1, (size_t)(r - regs.data())});
+        if (base + f.Frame > regs.size())
+            regs.resize(std::max<size_t>(base + f.Frame, regs.size() * 2), 0);
+        r = regs.data() + base;
+        ip = code + f.Entry;
+        NEXT;
+    }
+    CASE(bc_jmp) ip = code + ip->B; NEXT;
+    CASE(bc_jz) ip = r[ip->A] ? ip + 1 : code + ip->B; NEXT;
+    CASE(bc_jnz) ip = r[ip->A] ? code + ip->B : ip + 1; NEXT;
+    CASE(bc_loadk) r[ip->A] = ip->B; ip++; NEXT;
+    CASE(bc_cell) r[ip->A] = CELL; ip++; NEXT;
+    CASE(bc_getptr) r[ip->A] = p; ip++; NEXT;
+    CASE(bc_load) r[ip->A] = at(r[ip->B]); ip++; NEXT;
+    CASE(bc_loadi) r[ip->A] = at(ip->B); ip++; NEXT;
+    CASE(bc_loadup) r[ip->A] = at(p + ip->C + r[ip->B]); ip++; NEXT;
+    CASE(bc_loadupi) r[ip->A] = at(p + ip->B); ip++; NEXT;
+    CASE(bc_loaddn) r[ip->A] = at(p + ip->C - r[ip->B]); ip++; NEXT;
+    CASE(bc_loaddni) r[ip->A] = at(p - ip->B); ip++; NEXT;
+    CASE(bc_add) CELL = Arith::Add(CELL, r[ip->B]); ip++; NEXT;
+    CASE(bc_sub) CELL = Arith::Sub(CELL, r[ip->B]); ip++; NEXT;
+    CASE(bc_mul) CELL = Arith::Mul(CELL, r[ip->B]); ip++; NEXT;
+    CASE(bc_div)
+        if (!r[ip->B]) fail("Division by zero");
+        CELL = Arith::Quot(CELL, r[ip->B]); ip++; NEXT;
+    CASE(bc_set) CELL = r[ip->B]; ip++; NEXT;
+    CASE(bc_not) CELL = ~r[ip->B]; ip++; NEXT;
+    CASE(bc_and) CELL &= r[ip->B]; ip++; NEXT;
+    CASE(bc_or) CELL |= r[ip->B]; ip++; NEXT;
+    CASE(bc_xor) CELL ^= r[ip->B]; ip++; NEXT;
+    CASE(bc_addi) CELL = Arith::Add(CELL, ip->B); ip++; NEXT;
+    CASE(bc_subi) CELL = Arith::Sub(CELL, ip->B); ip++; NEXT;
+    CASE(bc_muli) CELL = Arith::Mul(CELL, ip->B); ip++; NEXT;
+    CASE(bc_seti) CELL = ip->B; ip++; NEXT;
+    CASE(bc_padd) p = Arith::Add(p, r[ip->B]); MOVED(); ip++; NEXT;
+    CASE(bc_psub) p = Arith::Sub(p, r[ip->B]); MOVED(); ip++; NEXT;
+    CASE(bc_pmul) p = Arith::Mul(p, r[ip->B]); MOVED(); ip++; NEXT;
+    CASE(bc_pdiv)
+        if (!r[ip->B]) fail("Division by zero");
+        p = Arith::Quot(p, r[ip->B]); MOVED(); ip++; NEXT;
+    CASE(bc_pset) p = r[ip->B]; MOVED(); ip++; NEXT;
+    CASE(bc_pnot) p = ~r[ip->B]; MOVED(); ip++; NEXT;
+    CASE(bc_pand) p &= r[ip->B]; MOVED(); ip++; NEXT;
+    CASE(bc_por) p |= r[ip->B]; MOVED(); ip++; NEXT;
+    CASE(bc_pxor) p ^= r[ip->B]; MOVED(); ip++; NEXT;
+    CASE(bc_paddi) p = Arith::Add(p, ip->B); MOVED(); ip++; NEXT;
+    CASE(bc_psubi) p = Arith::Sub(p, ip->B); MOVED(); ip++; NEXT;
+    CASE(bc_pseti) p = ip->B; MOVED(); ip++; NEXT;
+    CASE(bc_store) at(r[ip->B]) = p; ip++; NEXT;
+    CASE(bc_storei) at(ip->B) = p; ip++; NEXT;
+    CASE(bc_lt) r[ip->A] = r[ip->B] < r[ip->C]; ip++; NEXT;
+    CASE(bc_gt) r[ip->A] = r[ip->B] > r[ip->C]; ip++; NEXT;
+    CASE(bc_le) r[ip->A] = r[ip->B] <= r[ip->C]; ip++; NEXT;
+    CASE(bc_ge) r[ip->A] = r[ip->B] >= r[ip->C]; ip++; NEXT;
+    CASE(bc_eq) r[ip->A] = r[ip->B] == r[ip->C]; ip++; NEXT;
+    CASE(bc_ne) r[ip->A] = r[ip->B] != r[ip->C]; ip++; NEXT;
+    CASE(bc_lnot) r[ip->A] = !r[ip->B]; ip++; NEXT;
+    CASE(bc_truth) r[ip->A] = r[ip->B] != 0; ip++; NEXT;
+    CASE(bc_lxor) r[ip->A] = !r[ip->B] != !r[ip->C]; ip++; NEXT;
+    CASE(bc_print) io->put((unsigned char)CELL); ip++; NEXT;
+    CASE(bc_read) {
+        int ch = io->get();
+        CELL = ch == EOF ? 0 : ch;
+        ip++;
+        NEXT;
+    }
+    CASE(bc_clear) {
+        int &c = CELL;
+        if (!ip->A || (ip->A > 0 ? c > 0 : c < 0)) c = 0;
+        ip++;
+        NEXT;
+    }
+    CASE(bc_idiom) {
+        const Location *err;
+        try {
+            err = prog->Idioms[ip->B]->run(tape, p);
+        } catch (std::bad_alloc&) {
+            fail("Out of memory");
+        }
+        if (err) {
+            ptr = p;
+            throw std::exception(("RuntimeException: Pointer moved out of range to " + std::to_string(p) +
+                                  " at " + err->toString()).c_str());
+        }
+        size = tape.getSize();
+        MOVED();
+        ip++;
+        NEXT;
+    }
+#ifndef VM_COMPUTED_GOTO
+    default: fail("Invalid instruction");
+    }
+#endif
+#undef CASE
+#undef NEXT
+#undef MOVED
+#undef CELL
+
+done:
+    ptr = p;
+    io->flush();
+    return r[0];
+}
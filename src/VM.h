@@ -0,0 +1,31 @@
+//
+// Created by 7budd on 10/18/2026.
+//
+#ifndef BRAINPLUS_VM_H
+#define BRAINPLUS_VM_H
+
+#include <vector>
+#include "Bytecode.h"
+#include "IO.h"
+#include "Tape.h"
+
+//Dispatch loop for Bytecode (computed goto where the compiler supports it, a switch otherwise)
+//the tape base, tape pointer and current cell pointer are kept in locals while running.
+//a sparse tape gets its own instantiation of the loop, which looks every cell up instead.
+//semantics match the tree-walking Interpreter.
+class VM {
+    Tape tape;
+    std::vector<int> regs;
+    int ptr;
+    IO *io;
+    template <bool Sparse> int exec(const Bytecode *prog);
+public:
+    explicit VM(IO *io, Tape::Mode m = Tape::Dense) : tape(m), regs(256, 0), ptr(0), io(io) {}
+
+    int run(const Bytecode *prog);
+    int getPtr() const { return ptr; }
+    int getCell(int addr) const { return tape.get(addr); }
+    const Tape &getTape() const { return tape; }
+};
+
+#endif //BRAINPLUS_VM_H
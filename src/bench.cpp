@@ -0,0 +1,261 @@
+//
+// Created by 7budd on 10/18/2026.
+//
+//Benchmark runner: times each phase of the pipeline over a corpus of workloads
+//the corpus is every .bp file in the corpus directory (loop-heavy programs for the engines) plus a few large
+//sources generated on the fly (define- and code-heavy, for the front end). each workload runs once untimed,
+//then --reps times; every phase reports its min, median, mean and standard deviation.
+//workloads are single files: include statements are parsed but the included files are not read.
+//program output is captured in memory and only its size is reported.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "Parser.h"
+#include "FlatAST.h"
+#include "Interpreter.h"
+#include "CallStack.h"
+#include "VM.h"
+#include "JIT.h"
+#include "Optimizer.h"
+#ifdef _WINDOWS
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif
+
+#ifndef BRAINPLUS_BENCH_DIR
+#define BRAINPLUS_BENCH_DIR "bench"
+#endif
+
+enum Phase { p_lex, p_define, p_parse, p_opt, p_exec, NumPhases };
+static const char *PhaseNames[NumPhases] = { "lex", "define", "parse", "optimize", "execute" };
+
+struct Workload {
+    std::string Name, Path;
+    bool Generated;
+};
+struct Sample {
+    double Ms[NumPhases];
+    size_t Output;
+};
+
+std::string engine = "vm";
+
+static double now() {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static std::vector<std::string> listSources(const std::string& dir) {
+    std::vector<std::string> files;
+#ifdef _WINDOWS
+    WIN32_FIND_DATAA data;
+    HANDLE h = FindFirstFileA((dir + "\\*.bp").c_str(), &data);
+    if (h == INVALID_HANDLE_VALUE) return files;
+    do files.push_back(data.cFileName);
+    while (FindNextFileA(h, &data));
+    FindClose(h);
+#else
+    DIR *d = opendir(dir.c_str());
+    if (!d) return files;
+    while (dirent *e = readdir(d)) {
+        size_t len = strlen(e->d_name);
+        if (len > 3 && strcmp(e->d_name + len - 3, ".bp") == 0)
+            files.push_back(e->d_name);
+    }
+    closedir(d);
+#endif
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+//groups of chained defines (each one the previous plus a token) and a function per group that uses them
+static std::string genDefines(int groups, int depth) {
+    std::string src = "/*generated: " + std::to_string(groups) + " groups of " + std::to_string(depth) +
+                      " chained defines*/\n";
+    for (int g = 0; g < groups; g++) {
+        src += "define g" + std::to_string(g) + "_0 +1\n";
+        for (int d = 1; d < depth; d++)
+            src += "define g" + std::to_string(g) + '_' + std::to_string(d) + " g" + std::to_string(g) + '_' +
+                   std::to_string(d - 1) + " @+1 -1 @-1\n";
+    }
+    src += "enddef\n";
+    for (int g = 0; g < groups; g++)
+        src += 'f' + std::to_string(g) + " {\n  @=" + std::to_string(g % 64 + 1) + " g" + std::to_string(g) + '_' +
+               std::to_string(depth - 1) + " @+1 g" + std::to_string(g) + '_' + std::to_string(depth / 2) + "\n}\n";
+    src += "for (@=0 =0; <4; +) {\n";
+    for (int g = 0; g < groups; g++)
+        src += "  f" + std::to_string(g) + '\n';
+    src += "  @=0\n}\n@=1 &63 +48 . =10 .\n";
+    return src;
+}
+//long straight-line main code with nested blocks
+static std::string genCode(int lines) {
+    std::string src = "/*generated: " + std::to_string(lines) + " lines of straight-line code*/\n";
+    for (int i = 0; i < lines; i++) {
+        src += "@=" + std::to_string(i % 61 + 1) + " +" + std::to_string(i % 7 + 1) + " @+1 =@" +
+               std::to_string(i % 13 + 1) + " *3 @-1";
+        src += i % 10 == 9 ? " if (>100) { &127 } else { +(@#1 > 5) }\n" : "\n";
+    }
+    src += "@=1 &63 +48 . =10 .\n";
+    return src;
+}
+
+static Sample runOnce(const Workload& w) {
+    Sample s{};
+    SymbolTable<DefineNode> defines;
+    SymbolTable<FunctionNode> functions;
+    double t = now();
+    auto *lexer = new Lexer(w.Path);
+    s.Ms[p_lex] = now() - t;
+    if (!lexer->good()) {
+        delete lexer;
+        throw std::exception(("IOException: " + w.Path + " not good").c_str());
+    }
+
+    Parser parser(lexer, &defines, &functions);
+    t = now();
+    while (parser.parseInclude(".")) {}
+    while (auto def = parser.parseDefine())
+        defines.insert(def);
+    std::vector<std::string> cycle;
+    if (!Parser::ExpandDefines(&defines, cycle))
+        throw std::exception("RecursiveDefineException: defines create a cycle");
+    s.Ms[p_define] = now() - t;
+
+    t = now();
+    while (auto func = parser.parseFunction())
+        functions.insert(func);
+    StatementNode *code = parser.parseCode();
+    s.Ms[p_parse] = now() - t;
+    if (!code) throw std::exception("SyntaxException: no code parsed");
+
+    t = now();
+    code = Optimizer(parser.getArena(), &functions).run(code);
+    s.Ms[p_opt] = now() - t;
+
+    IO io;
+    io.setInput("");
+    io.captureOutput();
+    t = now();
+    if (engine == "tree") {
+        CallStack::Run([&] { Interpreter(&functions, &io).run(code); });
+    } else {
+        FlatAST flat;
+        for (auto func : functions)
+            flat.addFunction(func);
+        Bytecode *bytecode = BytecodeCompiler(&flat).compile(flat.add(code));
+        bool jitted = false;
+        if (engine == "jit") {
+            JIT jit(&io);
+            if ((jitted = jit.compile(bytecode)))
+                CallStack::Run([&] { jit.run(); });
+        }
+        if (!jitted)
+            VM(&io).run(bytecode);
+        delete bytecode;
+    }
+    s.Ms[p_exec] = now() - t;
+    s.Output = io.getOutput().size();
+    return s;
+}
+
+static void report(const Workload& w, const std::vector<Sample>& samples) {
+    printf("%s%s (%u reps, %u bytes of output)\n", w.Name.c_str(), w.Generated ? " [generated]" : "",
+           (unsigned int)samples.size(), (unsigned int)samples[0].Output);
+    for (int p = 0; p < NumPhases; p++) {
+        std::vector<double> ms;
+        double sum = 0, sq = 0;
+        for (auto &s : samples) {
+            ms.push_back(s.Ms[p]);
+            sum += s.Ms[p];
+        }
+        std::sort(ms.begin(), ms.end());
+        double mean = sum / ms.size();
+        for (double m : ms)
+            sq += (m - mean) * (m - mean);
+        double median = ms.size() % 2 ? ms[ms.size() / 2] : (ms[ms.size() / 2 - 1] + ms[ms.size() / 2]) / 2;
+        double stddev = ms.size() > 1 ? std::sqrt(sq / (ms.size() - 1)) : 0;
+        printf("  %-9s min %10.3f  median %10.3f  mean %10.3f  stddev %8.3f ms\n", PhaseNames[p], ms.front(),
+               median, mean, stddev);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    std::string corpus = BRAINPLUS_BENCH_DIR, filter;
+    int reps = 5;
+    bool generate = true;
+    for (int i = 1; i < argc; i++) {
+        std::string opt = argv[i];
+        if (opt.rfind("--corpus=", 0) == 0)
+            corpus = opt.substr(9);
+        else if (opt.rfind("--reps=", 0) == 0)
+            reps = std::max(1, atoi(opt.c_str() + 7));
+        else if (opt.rfind("--engine=", 0) == 0)
+            engine = opt.substr(9);
+        else if (opt.rfind("--filter=", 0) == 0)
+            filter = opt.substr(9);
+        else if (opt == "--no-gen")
+            generate = false;
+        else {
+            std::cerr << "Unknown option \"" + opt + "\"\n"
+                         "usage: brainplus_bench [--corpus=DIR] [--reps=N] [--engine=tree|vm|jit] [--filter=TEXT] "
+                         "[--no-gen]\n";
+            return 1;
+        }
+    }
+    if (engine != "tree" && engine != "vm" && engine != "jit") {
+        std::cerr << "Unknown engine \"" + engine + "\" (expected tree, vm or jit)\n";
+        return 1;
+    }
+
+    std::vector<Workload> workloads;
+    for (auto &f : listSources(corpus))
+        workloads.push_back({f.substr(0, f.size() - 3), corpus + '/' + f, false});
+    if (generate) {
+        //written to the working directory and removed afterwards
+        std::pair<std::string, std::string> gen[] = {
+            {"gen_defines", genDefines(2500, 8)},
+            {"gen_code", genCode(50000)},
+        };
+        for (auto &g : gen) {
+            std::string path = "brainplus_bench_" + g.first + ".bp";
+            std::ofstream out(path, std::ios::binary);
+            if (!(out << g.second)) {
+                std::cerr << "Could not write \"" + path + "\"\n";
+                return 1;
+            }
+            workloads.push_back({g.first, path, true});
+        }
+    }
+    if (workloads.empty()) {
+        std::cerr << "No workloads found in \"" + corpus + "\"\n";
+        return 1;
+    }
+
+    printf("engine: %s\n\n", engine.c_str());
+    int failed = 0;
+    for (auto &w : workloads) {
+        if (!filter.empty() && w.Name.find(filter) == std::string::npos) continue;
+        std::vector<Sample> samples;
+        try {
+            runOnce(w);
+            for (int i = 0; i < reps; i++)
+                samples.push_back(runOnce(w));
+        } catch (std::exception &e) {
+            printf("%s: failed: %s\n\n", w.Name.c_str(), e.what());
+            failed++;
+            continue;
+        }
+        report(w, samples);
+        printf("\n");
+    }
+    for (auto &w : workloads)
+        if (w.Generated) remove(w.Path.c_str());
+    return failed ? 2 : 0;
+}
@@ -38,6 +38,7 @@ enum NodeType {
     If,
     Ternary,
     For,
+    Idiom,
     Include,
     Call,
     Define,
@@ -226,6 +227,15 @@ public:
         return op == Operator::lessThan || op == Operator::lessOrEqual || op == Operator::equalTo ||
                op == Operator::greaterOrEqual || op == Operator::greaterThan || op == Operator::notEqual;
     }
+    static bool OpIsPtrComp(Operator op) {
+        return op == Operator::ptr_lessThan || op == Operator::ptr_lessOrEqual || op == Operator::ptr_equalTo ||
+               op == Operator::ptr_greaterOrEqual || op == Operator::ptr_greaterThan || op == Operator::ptr_notEqual;
+    }
+    //ops that address the current cell, or a cell relative to the pointer
+    static bool OpUsesCell(Operator op) {
+        return op == print || op == read || (op >= addition && op <= assignment) || op == bit_not || op == bit_and ||
+               op == bit_or || op == bit_xor || OpIsValComp(op) || op == ptr_lookupRelUp || op == ptr_lookupRelDown;
+    }
     static bool OpIsMultary(Operator op) {
         return OpIsValComp(op) || op == bool_and || op ==bool_or || op == bool_xor;
     }
@@ -1,8 +1,22 @@
+#include <chrono>
 #include <iostream>
+#include <fstream>
 #include <vector>
 #include <map>
+#include <set>
 #include <string>
 #include "Parser.h"
+#include "FlatAST.h"
+#include "Interpreter.h"
+#include "CallStack.h"
+#include "VM.h"
+#include "JIT.h"
+#include "CEmitter.h"
+#include "Optimizer.h"
+#include "Stats.h"
+#include "ThreadPool.h"
+#include "ParseCache.h"
+#include "Module.h"
 #ifdef _WINDOWS
 #include <direct.h>
 #define getCurDir _getcwd
@@ -12,9 +26,50 @@
 #endif
 
 std::string mainFile;
-std::map<IncludeNode*,Parser*> *includes;
-std::vector<DefineNode*> defines;
-std::vector<FunctionNode*> functions;
+std::string engine = "vm";  //tree, vm or jit
+std::string emitC;          //if set, write C source here instead of running
+std::string emitModule;     //if set, write the defines and functions here as a precompiled module instead of running
+std::string inputFile, outputFile;     //if set, , reads from and . writes to these instead of stdin/stdout
+Tape::Mode tapeMode = Tape::Dense;
+bool optimize = true, dumpOpt = false, inlineReport = false, tapeStats = false;
+Stats *stats = nullptr;     //set by --stats
+bool statsJson = false;
+std::map<std::string, double> lexMs;    //time spent lexing each file, by path
+unsigned int defineExpansions = 0;      //substitutions between defines; the lexers count the rest
+unsigned int jobs = 0;      //threads for lexing and parsing included files, 0 = one per core
+ParseCache *cache = nullptr;    //set by --cache
+uint64_t definesDigest = 0;     //ParseCache::HashDefines of the merged defines, when caching
+std::map<std::string, uint64_t> sourceHashes;   //hash of each file's source by file name, when caching
+std::vector<std::pair<IncludeNode*,Parser*>> *includes;     //in include order, the main file first
+SymbolTable<DefineNode> defines;
+SymbolTable<FunctionNode> functions;
+
+//one file of the include graph while the front end runs. each file is lexed and parsed by one pool task at a time,
+//into tables of its own; the main thread then merges the results in include order
+struct SourceFile {
+    IncludeNode *Node;
+    Parser *P;
+    double LexMs;
+    std::vector<IncludeNode*> Includes;
+    std::string Errors;     //logged by the parser, not printed yet
+    SymbolTable<DefineNode> Defines;
+    SymbolTable<FunctionNode> Functions;
+    std::vector<std::pair<DefineNode*, std::string>> DefineItems;
+    std::vector<std::pair<FunctionNode*, std::string>> FunctionItems;
+    //with --cache: the hash and length of the source text, the entry found for it, if any, and the sections to write back
+    uint64_t Source, Length;
+    ParseCache::Entry *Cached;
+    std::string DefineData, FunctionData;
+    bool Clean;     //no errors logged while parsing, so the file can be cached
+    //a precompiled module has no lexer; its definitions are loaded up front and merged like parsed ones
+    bool IsModule;
+    std::vector<DefineNode*> ModuleDefines;
+    std::vector<FunctionNode*> ModuleFunctions;
+    explicit SourceFile(IncludeNode *node, Parser *p = nullptr) : Node(node), P(p), LexMs(0), Source(0), Length(0),
+        Cached(nullptr), Clean(true), IsModule(false) {}
+    ~SourceFile() { delete Cached; }
+};
+std::vector<SourceFile*> sources;
 StatementNode *code;
 
 bool cp_ends_with(char* str, std::string suffix) {
@@ -41,38 +96,220 @@ std::string join(std::vector<std::string> elems, const std::string& delim) {
     return std::move(str);
 }
 int exit_msg(const std::string& msg, int code) {
-    for (auto func : functions)
-        delete func;
-    for (auto def : defines)
-        delete def;
-    for (auto inc : *includes) {
-        delete inc.first;
+    //every node lives in the arena of the parser that created it
+    for (auto inc : *includes)
         delete inc.second;
-    }
     delete includes;
     std::cerr << msg + '\n';
     exit(code);
 }
 
-void parseIncludes() {
+void printTapeStats(const Tape &tape) {
+    if (tape.getMode() == Tape::Dense) {
+        //the OS backs the region a page at a time, so only the usable size is known here
+        std::cerr << "Tape: dense, " + std::to_string(tape.getSize()) + " cells usable\n";
+        return;
+    }
+    size_t pages = tape.getPages();
+    std::cerr << "Tape: sparse, " + std::to_string(pages) + " pages of " + std::to_string(Tape::PageCells) +
+                 " cells touched (" + std::to_string(pages * Tape::PageCells * sizeof(int) / 1024) + " KiB)\n";
+}
+
+Lexer *lexFile(const std::string& path, double &ms) {
+    auto start = std::chrono::steady_clock::now();
+    auto *lex = new Lexer(path);
+    ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return lex;
+}
+//the lexer throws a SyntaxException for a file it can't tokenize, on whichever thread lexes it. the pool rethrows
+//the first one once every task has finished
+void waitFor(ThreadPool &pool) {
+    try {
+        pool.wait();
+    } catch (std::exception &e) {
+        exit_msg(e.what(), 3);
+    }
+}
+Stats::Counters totals() {
+    Stats::Counters c{0, 0, defineExpansions};
+    for (auto inc : *includes) {
+        c.Nodes += inc.second->getArena()->getNumNodes();
+        if (Lexer *lex = inc.second->getLexer()) {
+            c.Tokens += lex->getNumTokens();
+            c.Expansions += lex->getNumExpansions();
+        }
+    }
+    return c;
+}
+void beginPhase(const std::string& name) {
+    if (stats) stats->begin(name, totals());
+}
+void endPhase() {
+    if (stats) stats->end(totals());
+}
+
+//parses definitions of one kind until the parser stops, keeping the errors logged while parsing each one.
+//the last entry is null, with the errors that stopped it
+template <typename T>
+void parseItems(SourceFile *f, T *(Parser::*parse)(), std::vector<std::pair<T*, std::string>> &items,
+                SymbolTable<T> &local) {
+    for (;;) {
+        T *item = (f->P->*parse)();
+        if (!f->Errors.empty()) f->Clean = false;
+        items.emplace_back(item, f->Errors);
+        f->Errors.clear();
+        if (!item) return;
+        local.insert(item);
+    }
+}
+//the same for definitions loaded from the cache, which never have errors
+template <typename T>
+void addItems(const std::vector<T*> &nodes, std::vector<std::pair<T*, std::string>> &items, SymbolTable<T> &local) {
+    for (auto node : nodes) {
+        items.emplace_back(node, "");
+        local.insert(node);
+    }
+    items.emplace_back(nullptr, "");
+}
+template <typename T>
+std::vector<T*> itemNodes(const std::vector<std::pair<T*, std::string>> &items) {
+    std::vector<T*> nodes;
+    for (auto &item : items)
+        if (item.first) nodes.push_back(item.first);
+    return nodes;
+}
+//adds a file's definitions to the shared table, printing errors as if the files had been parsed one after another:
+//a name already defined by an earlier file stops the file there, like it stops the parser
+template <typename T>
+void mergeItems(std::vector<std::pair<T*, std::string>> &items, SymbolTable<T> &table, const std::string& kind,
+                const std::string& taken) {
+    for (auto &item : items) {
+        if (item.first && table.contains(item.first->getSymbol())) {
+            std::cerr << "MultipleDefinitionException: " + kind + " \"" + item.first->getId() + "\" at " +
+                         item.first->getLocString() + ' ' + taken + ".\n";
+            break;
+        }
+        std::cerr << item.second;
+        if (item.first) table.insert(item.first);
+    }
+    items.clear();
+}
+
+//with --cache: hashes a file's source and looks up its entry. on a hit the file gets a parser without a lexer
+//and its include statements come from the entry
+bool loadCached(SourceFile *f) {
+    SourceBuffer src(f->Node->getId());
+    if (!src.good()) return false;
+    f->Source = ParseCache::Hash(src.begin(), src.length());
+    f->Length = src.length();
+    auto *entry = new ParseCache::Entry();
+    if (!cache->load(f->Source, f->Length, *entry) || entry->Dir != f->Node->getDir()) {
+        delete entry;
+        return false;
+    }
+    f->Cached = entry;
+    f->P = new Parser(nullptr, &f->Defines, &f->Functions);
+    f->P->collectErrors(&f->Errors);
+    for (auto &inc : entry->Includes)
+        f->Includes.push_back(f->P->getArena()->make<IncludeNode>(inc.Id, inc.Loc));
+    return true;
+}
+//loads an included .bpm. returns false if there is no such file, which is skipped like a missing source
+bool loadModule(SourceFile *f) {
+    SourceBuffer src(f->Node->getId());
+    if (!src.good()) return false;
+    std::string error;
+    f->P = new Parser(nullptr, &f->Defines, &f->Functions);
+    f->IsModule = true;
+    if (!Module::Load(src.begin(), src.end(), f->P->getArena(), f->ModuleDefines, f->ModuleFunctions, error))
+        f->Errors += "ModuleException: \"" + f->Node->getId() + "\" " + error + ".\n";
+    if (cache) f->Source = ParseCache::Hash(src.begin(), src.length());
+    return true;
+}
+//lexes a file whose entry turned out to be stale after all, and parses past the statements still taken from it
+void lexCached(SourceFile *f, bool skipDefines) {
+    f->P->setLexer(lexFile(f->Node->getId(), f->LexMs));
+    while (f->P->parseInclude(f->Node->getDir())) {}
+    if (skipDefines) {
+        SymbolTable<DefineNode> scratch;
+        f->P->setTables(&scratch, &f->Functions);
+        while (f->P->parseDefine()) {}
+    }
+}
+void storeCached(SourceFile *f) {
+    ParseCache::Entry entry;
+    entry.Dir = f->Node->getDir();
+    for (auto inc : f->Includes) {
+        auto it = sourceHashes.find(inc->getFname());
+        entry.Includes.push_back({inc->getId(), inc->getLoc(), it == sourceHashes.end() ? 0 : it->second});
+    }
+    entry.Defines = definesDigest;
+    entry.DefineData = f->DefineData;
+    entry.FunctionData = f->FunctionData;
+    cache->store(f->Source, f->Length, entry);
+}
+
+void parseIncludes(ThreadPool &pool, SourceFile *root) {
     // loop thru includes:
     //   parse include statements. if not in inlcudes and lexer is good, then add to includes
-    for (auto it = includes->begin(); it != includes->end(); it++) {
-        while (auto inc = it->second->parseInclude(it->first->getDir())) {
-            bool keep = true;
-            if (!cp_ends_with((char*)inc->getId().c_str(), ".bp"))
-                continue;
-            for (auto pair : *includes)
-                if (pair.first->getFname() == inc->getFname()) {
-                    keep = false;
-                    break;
+    //each wave lexes the files found by the previous one and parses their include statements in parallel.
+    //new files are picked between waves in include order, so the file order doesn't depend on scheduling
+    //every file name ever put in a wave, so a file included twice in one wave is only read once
+    std::set<std::string> queued = {root->Node->getFname()};
+    std::vector<SourceFile*> wave = {root};
+    while (!wave.empty()) {
+        for (auto f : wave)
+            pool.submit([f] {
+                if (!f->P && cp_ends_with((char*)f->Node->getId().c_str(), ".bpm")) {
+                    loadModule(f);
+                    return;
+                }
+                if (!f->P && !(cache && loadCached(f))) {
+                    Lexer *lex = lexFile(f->Node->getId(), f->LexMs);
+                    if (!lex->good()) {
+                        delete lex;
+                        return;
+                    }
+                    f->P = new Parser(lex, &f->Defines, &f->Functions);
+                    f->P->collectErrors(&f->Errors);
                 }
-            if (!keep) continue;
-            auto lex = new Lexer(inc->getId());
-            if (lex->good())
-                includes->insert(std::pair<IncludeNode*, Parser*>(inc, new Parser(lex, &defines, &functions)));
-            else delete lex;
+                if (f->P->getLexer())
+                    while (auto inc = f->P->parseInclude(f->Node->getDir()))
+                        f->Includes.push_back(inc);
+            });
+        waitFor(pool);
+        std::vector<SourceFile*> next;
+        for (auto f : wave) {
+            if (!f->P) {
+                delete f;
+                continue;
+            }
+            if (f != root) {
+                includes->push_back(std::pair<IncludeNode*, Parser*>(f->Node, f->P));
+                sources.push_back(f);
+            }
+            if (!f->Errors.empty()) f->Clean = false;
+            std::cerr << f->Errors;
+            f->Errors.clear();
+            for (auto inc : f->Includes)
+                if ((cp_ends_with((char*)inc->getId().c_str(), ".bp") ||
+                     cp_ends_with((char*)inc->getId().c_str(), ".bpm")) && queued.insert(inc->getFname()).second)
+                    next.push_back(new SourceFile{inc});
         }
+        wave = next;
+    }
+    //an entry is only used if the files it includes are unchanged too
+    if (cache) {
+        for (auto f : sources)
+            sourceHashes[f->Node->getFname()] = f->Source;
+        for (auto f : sources)
+            for (unsigned int i = 0; f->Cached && i < f->Includes.size(); i++) {
+                auto it = sourceHashes.find(f->Includes[i]->getFname());
+                if ((it == sourceHashes.end() ? 0 : it->second) != f->Cached->Includes[i].Source) {
+                    delete f->Cached;
+                    f->Cached = nullptr;
+                }
+            }
     }
     /*TEST 1: Includes*
     std::cout << "Included files:";
@@ -81,12 +318,34 @@ void parseIncludes() {
     std::cout << '\n';
     /*END TEST 1*/
 }
-void parseDefines() {
+void parseDefines(ThreadPool &pool) {
     // loop thru includes:
     //   parse define statements. if define name in defines, throw error, otherwise add to defines
-    for (auto inc : *includes)
-        while (auto def = inc.second->parseDefine())
-            defines.push_back(def);
+    for (auto f : sources)
+        pool.submit([f] {
+            if (f->IsModule) {
+                addItems(f->ModuleDefines, f->DefineItems, f->Defines);
+                return;
+            }
+            if (f->Cached) {
+                std::vector<DefineNode*> nodes;
+                if (ParseCache::LoadDefines(f->Cached->DefineData, f->P->getArena(), nodes)) {
+                    addItems(nodes, f->DefineItems, f->Defines);
+                    f->DefineData = f->Cached->DefineData;
+                    return;
+                }
+                delete f->Cached;
+                f->Cached = nullptr;
+            }
+            if (!f->P->getLexer()) lexCached(f, false);
+            parseItems(f, &Parser::parseDefine, f->DefineItems, f->Defines);
+            //saved before ExpandDefines rewrites them
+            if (cache) f->DefineData = ParseCache::SaveDefines(itemNodes(f->DefineItems));
+        });
+    waitFor(pool);
+    for (auto f : sources)
+        mergeItems(f->DefineItems, defines, "Define", "is already defined");
+    if (cache) definesDigest = ParseCache::HashDefines(defines);
     /*TEST 2.1: Recursive Defines*
     std::cout << "Defines::\n";
     for (auto def : defines)
@@ -95,61 +354,116 @@ void parseDefines() {
 
     // loop thru define statements:
     //   if contains reference to itself, throw error, otherwise replace any occurrence (call node) in other define statements
-    auto defNames = new std::vector<std::string>();
-    DefineNode *d;
-    for (auto def : defines) {
-        defNames->clear();
-        defNames->push_back(def->getId());
-        for (int i = 0; i < def->getNumReplacements(); i++)
-            if (def->getReplacement(i)->Type == TokenType::t_identifier) {
-                if (def->getReplacement(i)->Identifier == def->getId())
-                    exit_msg("RecursiveDefineException: Some or all of the following defines create a cycle - " +
-                             join(*defNames, ", "), 4);
-                if ((d = GetDefine(def->getReplacement(i)->Identifier, &defines))) {
-                    defNames->push_back(d->getId());
-                    def->setReplacement(d->getReplacements(), i--);
-                    break;
-                }
-            }
-    }
-    delete defNames;
+    std::vector<std::string> cycle;
+    if (!Parser::ExpandDefines(&defines, cycle, &defineExpansions))
+        exit_msg("RecursiveDefineException: The following defines create a cycle - " + join(cycle, " -> "), 4);
     /*TEST 2.2: Cyclic Defines*
     std::cout << "\nDefines::\n";
     for (auto def : defines)
         std::cout << def->to_string() + '\n';
     /*END TEST 2.2*/
 }
-void checkForIdentifier(std::string id, Location l) {
-    if (!GetDefine(id, &defines) && !GetFunction(id, &functions))
-        exit_msg("UnknownIdentifierException: Unknown identifier \"" + id + "\" at " + l.toString(), 5);
+void dumpProgram(const std::string& title) {
+    std::cout << title + ":\n";
+    for (auto func : functions)
+        std::cout << func->to_string() + '\n';
+    std::cout << "Code:\n" + (code ? code->to_string() : "") + "\n\n";
+}
+void checkForIdentifier(Symbol id, Location l) {
+    if (!defines.contains(id) && !functions.contains(id))
+        exit_msg("UnknownIdentifierException: Unknown identifier \"" + Interner::Lookup(id) + "\" at " + l.toString(), 5);
 }
 void checkForUnknownIds() {
     // loop thru defines and functions:
     //   check for any remaining call nodes that are unidentified
     for (auto def : defines)
-        for (int i = 0; i < def->getNumReplacements(); i++)
-            if (def->getReplacement(i)->Type == TokenType::t_identifier)
-                checkForIdentifier(def->getReplacement(i)->Identifier, def->getReplacement(i)->Loc);
+        for (unsigned int i = 0; i < def->getNumReplacements(); i++)
+            if (def->getReplacement(i).Type == TokenType::t_identifier)
+                checkForIdentifier(def->getReplacement(i).Id, def->getReplacement(i).Loc);
     for (auto func : functions)
         if (func->getBody()->getType() == NodeType::MultiStatement) {
             auto *m = (MultiStatementNode*)func->getBody();
-            for (int i = 0; i < m->getNumStatements(); i++)
+            for (unsigned int i = 0; i < m->getNumStatements(); i++)
                 if (m->getStatement(i)->getType() == NodeType::Call)
-                    checkForIdentifier(((CallNode *) m->getStatement(i))->getId(), m->getStatement(i)->getLoc());
+                    checkForIdentifier(((CallNode *) m->getStatement(i))->getSymbol(), m->getStatement(i)->getLoc());
         } else if (func->getBody()->getType() == NodeType::Call)
-            checkForIdentifier(((CallNode *) func->getBody())->getId(), func->getBody()->getLoc());
+            checkForIdentifier(((CallNode *) func->getBody())->getSymbol(), func->getBody()->getLoc());
+}
+
+void addFileStats() {
+    if (!stats) return;
+    for (auto inc : *includes) {
+        //files loaded from the cache or a module were never lexed
+        Lexer *lex = inc.second->getLexer();
+        if (!lex) {
+            bool module = cp_ends_with((char*)inc.first->getId().c_str(), ".bpm");
+            stats->addFile({inc.first->getId() + (module ? " (module)" : " (cached)"), 0, 0,
+                            {0, inc.second->getArena()->getNumNodes(), 0}});
+            continue;
+        }
+        stats->addFile({inc.first->getId(), lex->getSourceSize(), lexMs[inc.first->getId()],
+                        {lex->getNumTokens(), inc.second->getArena()->getNumNodes(), lex->getNumExpansions()}});
+    }
+}
+int finish() {
+    if (stats) {
+        std::cerr << (statsJson ? stats->toJson() : stats->toText());
+        delete stats;
+    }
+    delete cache;
+
+    // delete AST (each parser frees its whole arena at once)
+    for (auto inc : *includes)
+        delete inc.second;
+    delete includes;
+    return 0;
 }
 
 int main(int argc, char *argv[]) {
     //create variables
-    includes = new std::map<IncludeNode*,Parser*>();
+    includes = new std::vector<std::pair<IncludeNode*, Parser*>>();
 
     // get mainFile and add to includes
     if (argc <= 1) exit_msg("A source file must be specified", 1);
     if (!cp_ends_with(argv[1], ".bp"))
         exit_msg("Brainplus source files must have \"bp\" extension", 2);
+    // get options following the source file
+    for (int i = 2; i < argc; i++) {
+        std::string opt = argv[i];
+        if (opt.rfind("--engine=", 0) == 0)
+            engine = opt.substr(9);
+        else if (opt.rfind("--emit-c=", 0) == 0)
+            emitC = opt.substr(9);
+        else if (opt.rfind("--emit-module=", 0) == 0)
+            emitModule = opt.substr(14);
+        else if (opt == "--no-opt")
+            optimize = false;
+        else if (opt == "--dump-opt")
+            dumpOpt = true;
+        else if (opt == "--inline-report")
+            inlineReport = true;
+        else if (opt == "--tape=dense" || opt == "--tape=sparse")
+            tapeMode = opt == "--tape=dense" ? Tape::Dense : Tape::Sparse;
+        else if (opt == "--tape-stats")
+            tapeStats = true;
+        else if (opt.rfind("--input=", 0) == 0)
+            inputFile = opt.substr(8);
+        else if (opt.rfind("--output=", 0) == 0)
+            outputFile = opt.substr(9);
+        else if (opt.rfind("--cache=", 0) == 0)
+            cache = new ParseCache(opt.substr(8));
+        else if (opt.rfind("--jobs=", 0) == 0)
+            jobs = atoi(opt.c_str() + 7);
+        else if (opt == "--stats" || opt == "--stats=text" || opt == "--stats=json") {
+            stats = new Stats();
+            statsJson = opt == "--stats=json";
+        }
+        else exit_msg("Unknown option \"" + opt + '"', 1);
+    }
+    if (engine != "tree" && engine != "vm" && engine != "jit")
+        exit_msg("Unknown engine \"" + engine + "\" (expected tree, vm or jit)", 1);
     mainFile = argv[1];
-    if (mainFile.find(':') == -1) {
+    if (mainFile.find(':') == std::string::npos) {
         char* tmp = (char*)malloc(FILENAME_MAX);
         std::string dir = getCurDir(tmp, FILENAME_MAX);
         free(tmp);
@@ -158,38 +472,177 @@ int main(int argc, char *argv[]) {
         else if (dir[dir.size() - 1] != '\\' && mainFile[0] != '\\')
             mainFile = dir + '\\' + mainFile;
     }
-    auto *lexer = new Lexer(mainFile = argv[1]);
+    beginPhase("lex");
+    Lexer *lexer = nullptr;
+    try {
+        lexer = lexFile(mainFile = argv[1], lexMs[argv[1]]);
+    } catch (std::exception &e) {
+        exit_msg(e.what(), 3);
+    }
     if (!lexer->good()) exit_msg("Main file not found", 3);
-    includes->insert(std::pair<IncludeNode*, Parser*>(new IncludeNode(mainFile, {0, 0}),
-                                                     new Parser(lexer, &defines, &functions)));
+    auto *mainSrc = new SourceFile(nullptr);
+    auto *parser = mainSrc->P = new Parser(lexer, &mainSrc->Defines, &mainSrc->Functions);
+    parser->collectErrors(&mainSrc->Errors);
+    mainSrc->Node = parser->getArena()->make<IncludeNode>(mainFile, Location{0, 0});
+    includes->push_back(std::pair<IncludeNode*, Parser*>(mainSrc->Node, parser));
+    sources.push_back(mainSrc);
     //add other specified files to include?
+    endPhase();
 
-    parseIncludes();
-    parseDefines();
+    {
+        ThreadPool pool(jobs ? jobs : ThreadPool::DefaultThreads());
+        beginPhase("includes");
+        parseIncludes(pool, mainSrc);
+        endPhase();
+        beginPhase("defines");
+        parseDefines(pool);
+        endPhase();
 
-    // loop thru includes:
-    //   parse function definitions. if function name in functions or defines, throw error, otherwise add to functions
-    for (auto inc : *includes)
-        while (auto func = inc.second->parseFunction())
-            functions.push_back(func);
+        // loop thru includes:
+        //   parse function definitions. if function name in functions or defines, throw error, otherwise add to functions
+        //every file sees all the defines now, and its own functions until they are merged
+        beginPhase("functions");
+        for (auto f : sources)
+            pool.submit([f] {
+                if (f->IsModule) {
+                    addItems(f->ModuleFunctions, f->FunctionItems, f->Functions);
+                    return;
+                }
+                if (f->Cached && f->Cached->Defines == definesDigest) {
+                    std::vector<FunctionNode*> nodes;
+                    if (ParseCache::LoadFunctions(f->Cached->FunctionData, f->P->getArena(), nodes)) {
+                        addItems(nodes, f->FunctionItems, f->Functions);
+                        return;
+                    }
+                }
+                if (!f->P->getLexer()) lexCached(f, true);
+                f->P->setTables(&defines, &f->Functions);
+                parseItems(f, &Parser::parseFunction, f->FunctionItems, f->Functions);
+                if (cache) f->FunctionData = ParseCache::SaveFunctions(itemNodes(f->FunctionItems));
+            });
+        waitFor(pool);
+        for (auto f : sources) {
+            //files whose functions were parsed again are written back
+            if (cache && f != mainSrc && f->Clean && !f->FunctionData.empty()) storeCached(f);
+            mergeItems(f->FunctionItems, functions, "Function", "is previously defined");
+            f->P->setTables(&defines, &functions);
+            f->P->collectErrors(nullptr);
+            if (f != mainSrc) lexMs[f->Node->getId()] = f->LexMs;
+            delete f;
+        }
+        sources.clear();
+        endPhase();
+    }
     /*TEST 3: Function Definitions*
     std::cout << "Function::\n";
     for (auto func : functions)
         std::cout << func->to_string() + '\n';
     /*END TEST 3*/
 
+    beginPhase("check");
     checkForUnknownIds();
+    endPhase();
+
+    //a module is only the definitions, so the main file's code is not parsed
+    if (!emitModule.empty()) {
+        beginPhase("emit");
+        std::ofstream out(emitModule, std::ios::binary);
+        if (!(out << Module::Save(defines, functions)))
+            exit_msg("Could not write \"" + emitModule + '"', 1);
+        endPhase();
+        addFileStats();
+        return finish();
+    }
 
     // parse code statements in mainFile
     // codegen functions
+    beginPhase("code");
     for (auto inc : *includes)
         if (inc.first->getId() == mainFile)
             code = inc.second->parseCode();
-    /*TEST 4: Code*/
+    endPhase();
+    addFileStats();
+    /*TEST 4: Code*
     std::cout << "Code:\n" + code->to_string();
     /*END TEST 4*/
 
+    // optimize functions and code statements
+    if (optimize) {
+        if (dumpOpt) dumpProgram("Before optimization");
+        beginPhase("optimize");
+        Optimizer optimizer(parser->getArena(), &functions);
+        code = optimizer.run(code);
+        endPhase();
+        if (inlineReport) {
+            std::cout << "Inlined calls:\n";
+            for (auto &in : optimizer.getInlined())
+                std::cout << "  " + Interner::Lookup(in.Id) + " (" + std::to_string(in.Size) + " nodes) at " +
+                             in.At.toString() + '\n';
+            std::cout << '\n';
+        }
+        if (dumpOpt) dumpProgram("After optimization");
+    }
+    /*TEST 5: Flat AST (should match TEST 4)*
+    FlatAST flat;
+    std::cout << "\nFlat code:\n" + flat.to_string(flat.add(code));
+    /*END TEST 5*/
+
+    // run mainFile code statements
+    IO io;
+    if (!inputFile.empty() && !io.openInput(inputFile))
+        exit_msg("Could not read \"" + inputFile + '"', 1);
+    if (!outputFile.empty() && !io.openOutput(outputFile))
+        exit_msg("Could not write \"" + outputFile + '"', 1);
+    try {
+        if (!emitC.empty()) {
+            beginPhase("emit");
+            std::ofstream out(emitC, std::ios::binary);
+            if (!(out << CEmitter(&functions).emit(code, mainFile)))
+                exit_msg("Could not write \"" + emitC + '"', 1);
+            endPhase();
+        } else if (engine == "tree") {
+            beginPhase("run");
+            Interpreter interpreter(&functions, &io, tapeMode);
+            CallStack::Run([&] { interpreter.run(code); });
+            endPhase();
+            if (tapeStats) printTapeStats(interpreter.getTape());
+        } else {
+            beginPhase("compile");
+            FlatAST flat;
+            for (auto func : functions)
+                flat.addFunction(func);
+            Bytecode *bytecode = BytecodeCompiler(&flat).compile(flat.add(code));
+            endPhase();
+            /*TEST 6: Bytecode*
+            std::cout << bytecode->to_string();
+            /*END TEST 6*/
+            //the jit falls back to the vm on machines it can't generate code for, with a sparse tape, and for programs
+            //whose register file would be too large
+            bool jitted = false;
+            beginPhase("run");
+            if (engine == "jit" && tapeMode == Tape::Dense) {
+                JIT jit(&io);
+                if ((jitted = jit.compile(bytecode))) {
+                    CallStack::Run([&] { jit.run(); });
+                    if (tapeStats) printTapeStats(jit.getTape());
+                }
+            }
+            if (!jitted) {
+                VM vm(&io, tapeMode);
+                vm.run(bytecode);
+                if (tapeStats) printTapeStats(vm.getTape());
+            }
+            endPhase();
+            delete bytecode;
+        }
+    } catch (std::exception &e) {
+        io.flush();
+        exit_msg(e.what(), 6);
+    }
+    io.flush();
+    if (io.failed())
+        exit_msg(outputFile.empty() ? "Could not write output" : "Could not write \"" + outputFile + '"', 1);
+
     // codegen mainFile code statements
-    // delete AST
-    return 0;
+    return finish();
 }